@@ -2,24 +2,57 @@
 #include <raymath.h>
 #include <scene.h>
 #include <string.h>
+#include <float.h>
 #include <rlgl.h>
 
-static void *ListAlloc(void **list, unsigned long *count, unsigned long *capacity, unsigned long size)
-{
-    if (*count >= *capacity)
-    {
-        *capacity = (*capacity == 0) ? 8 : *capacity * 2;
-        *list = *list ? MemRealloc(*list, *capacity * size) : MemAlloc(*capacity * size);
-    }
-    char *byteList = (char *)*list;
-    char *ptr = &byteList[*count * size];
-    *count += 1;
-    for (unsigned long i = 0; i < size; i++)
-    {
-        ptr[i] = 0;
-    }
-    return (void *)ptr;
-}
+// SIMD support for the transform and culling kernels is chosen at build time;
+// define SCENE_DISABLE_SIMD to use the scalar code paths only
+#if !defined(SCENE_DISABLE_SIMD) && defined(__AVX__)
+    #include <immintrin.h>
+    #define SCENE_SIMD_WIDTH 8
+    typedef __m256 SceneFloatV;
+    #define SimdSet1(a) _mm256_set1_ps(a)
+    #define SimdLoad(p) _mm256_loadu_ps(p)
+    #define SimdStore(p, a) _mm256_storeu_ps(p, a)
+    #define SimdAdd(a, b) _mm256_add_ps(a, b)
+    #define SimdSub(a, b) _mm256_sub_ps(a, b)
+    #define SimdMul(a, b) _mm256_mul_ps(a, b)
+    #define SimdAnd(a, b) _mm256_and_ps(a, b)
+    #define SimdOr(a, b) _mm256_or_ps(a, b)
+    #define SimdXor(a, b) _mm256_xor_ps(a, b)
+    #define SimdCmpEq(a, b) _mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+    #define SimdCmpGe(a, b) _mm256_cmp_ps(a, b, _CMP_GE_OQ)
+    #define SimdBlend(a, b, mask) _mm256_blendv_ps(a, b, mask)
+    #define SimdRound(a) _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)
+    #define SimdMoveMask(a) _mm256_movemask_ps(a)
+#elif !defined(SCENE_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #include <emmintrin.h>
+    #define SCENE_SIMD_WIDTH 4
+    typedef __m128 SceneFloatV;
+    #define SimdSet1(a) _mm_set1_ps(a)
+    #define SimdLoad(p) _mm_loadu_ps(p)
+    #define SimdStore(p, a) _mm_storeu_ps(p, a)
+    #define SimdAdd(a, b) _mm_add_ps(a, b)
+    #define SimdSub(a, b) _mm_sub_ps(a, b)
+    #define SimdMul(a, b) _mm_mul_ps(a, b)
+    #define SimdAnd(a, b) _mm_and_ps(a, b)
+    #define SimdOr(a, b) _mm_or_ps(a, b)
+    #define SimdXor(a, b) _mm_xor_ps(a, b)
+    #define SimdCmpEq(a, b) _mm_cmpeq_ps(a, b)
+    #define SimdCmpGe(a, b) _mm_cmpge_ps(a, b)
+    #define SimdBlend(a, b, mask) _mm_or_ps(_mm_andnot_ps(mask, a), _mm_and_ps(mask, b))
+    #define SimdRound(a) _mm_cvtepi32_ps(_mm_cvtps_epi32(a))
+    #define SimdMoveMask(a) _mm_movemask_ps(a)
+#endif
+
+// scenes with SCENE_FLAG_PARALLEL_TRANSFORMS update their transforms on a worker pool;
+// define SCENE_DISABLE_THREADS to always update on the calling thread and SCENE_WORKER_COUNT
+// to override the number of threads (the detected core count, at most 8)
+#if !defined(SCENE_DISABLE_THREADS) && !defined(_MSC_VER)
+    #include <pthread.h>
+    #include <unistd.h>
+    #define SCENE_THREADS
+#endif
 
 typedef struct SceneModel
 {
@@ -29,47 +62,210 @@ typedef struct SceneModel
     char isManaged;
     BoundingBox *meshBounds;
     Vector4 *meshBoundingSpheres;
+    // union of the mesh bounds
+    BoundingBox bounds;
 } SceneModel;
 
+// how a node's rotation is stored; quaternion rotations need no trigonometry when composing matrices
+#define SCENE_ROTATION_EULER 0
+#define SCENE_ROTATION_QUATERNION 1
+
+// what a node's local transform consists of, classified whenever its rotation or scale is set;
+// the cheaper kinds get their own kernels in the transform update
+#define SCENE_TRANSFORM_GENERAL 0
+// no rotation and a scale of 1
+#define SCENE_TRANSFORM_TRANSLATION 1
+// euler rotation around the y axis only, any scale
+#define SCENE_TRANSFORM_ROTATION_Y 2
+
+// marks a missing node in the 32 bit node links
+#define SCENE_NODE_INDEX_NONE 0xFFFFFFFFu
+// bounds of nodes without meshes; min is greater than max, so any union replaces them
+#define SCENE_EMPTY_BOUNDS ((BoundingBox){{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}})
+// the scene slot has to fit into the 8 bits reserved for it in SceneNodeHandle
+#define SCENE_MAX_SCENE_COUNT 256
+
+// upper three rows of an affine Matrix, with the same memory layout as its first 12 floats;
+// the bottom row is always (0, 0, 0, 1)
+typedef struct SceneAffineMatrix
+{
+    float m0, m4, m8, m12;
+    float m1, m5, m9, m13;
+    float m2, m6, m10, m14;
+} SceneAffineMatrix;
+
+#define SCENE_AFFINE_IDENTITY (SceneAffineMatrix){1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0}
+
+// cold node data that is not needed for transform updates and culling;
+// the hot data lives in the node arrays of the scene
 typedef struct SceneNode
 {
-    long generation;
-    SceneNodeId parent;
-    SceneNodeId nextSiblingId;
-    SceneNodeId firstChildId;
-
-    // the generation of the transform data; is increased when TRS is modified
-    unsigned long modTRSGeneration;
-    // if modTRSMarker != modTRSGeneration, the TRS matrix is dirty
-    unsigned long modTRSMarker;
-
-    Vector3 position;
-    Vector3 rotation;
-    Vector3 scale;
-    char *name;
-    Matrix localToWorld;
-    Matrix worldToLocal;
+    // node slots or SCENE_NODE_INDEX_NONE; free slots are chained through nextSibling
+    unsigned int nextSibling;
+    unsigned int prevSibling;
+    unsigned int firstChild;
+
+    // interned name or 0 if the node has no name
+    unsigned int nameId;
+    // ids of the other nodes listed under the same key of the name index,
+    // indexed by SCENE_NAME_CHAIN_*
+    unsigned int prevNamed[2];
+    unsigned int nextNamed[2];
+    // key of the node's first component or SCENE_NODE_INDEX_NONE, see SCENE_COMPONENT_KEY
+    unsigned int firstComponent;
 
     // SceneNode metadata
     int userIdentifier;
-    SceneModelId model;
-
-    
 } SceneNode;
 
+// node of a bounding volume hierarchy over node bounds; leaves refer to a scene node by its id
+typedef struct SceneBVHNode
+{
+    BoundingBox bounds;
+    // tree nodes or SCENE_NODE_INDEX_NONE; child1 is SCENE_NODE_INDEX_NONE for leaves and
+    // chains the free nodes
+    unsigned int parent;
+    unsigned int child1;
+    unsigned int child2;
+    // scene node slot of leaves, which CompactScene keeps up to date
+    unsigned int nodeIndex;
+    // number of meshes below the node
+    unsigned int meshCount;
+    // set when the box needs a refit; all ancestors of a marked node are marked too
+    char isDirty;
+} SceneBVHNode;
+
+typedef struct SceneBVH
+{
+    SceneBVHNode *nodes;
+    unsigned int root;
+    unsigned int firstFree;
+    unsigned long count;
+    unsigned long capacity;
+    // summed area of the inner nodes; relative to the root's area, it's the expected cost of a query
+    double innerArea;
+    // cost above which the tree is rebuilt
+    float rebuildCost;
+    // set for trees grown from nothing and for leaves that were added without an insertion
+    char isRebuildPending;
+    // set while so many leaves change that the next refit covers the whole tree instead
+    char isFullRefit;
+} SceneBVH;
+
+typedef struct SceneBVHStackEntry
+{
+    unsigned int node;
+    // entry distance of the ray for raycasts
+    float distance;
+} SceneBVHStackEntry;
+
+typedef struct SceneHierarchyEntry
+{
+    unsigned int nodeIndex;
+    // index of the parent node or SCENE_NODE_INDEX_NONE for root nodes
+    unsigned int parentIndex;
+} SceneHierarchyEntry;
+
+typedef struct SceneNameIndexEntry
+{
+    // id of the parent node, SCENE_NODE_INDEX_NONE for root nodes or SCENE_NAME_ANY_PARENT
+    unsigned int parentKey;
+    unsigned int nameId;
+    // SCENE_NODE_INDEX_NONE for empty entries
+    unsigned int nodeId;
+} SceneNameIndexEntry;
+
+// dense pool of the components of one definition
 typedef struct SceneComponentData
 {
+    // count components of componentDataSize bytes each, packed without gaps
     unsigned char *componentData;
+    // id of the node and slot of every packed component
+    unsigned int *componentNodeIds;
+    unsigned int *componentSlots;
+    unsigned long componentDataSize;
+    unsigned long count;
+    unsigned long capacity;
+
+    // SceneNodeComponentIds refer to slots, which don't move when components are removed.
+    // slotIndices holds the packed index of a live slot or the next free slot after firstFreeSlot;
+    // live slots have an odd generation
+    unsigned int *slotIndices;
+    unsigned short *slotGenerations;
+    // key of the next component of the same node, see SCENE_COMPONENT_KEY
+    unsigned int *slotNextOfNode;
+    unsigned int firstFreeSlot;
+    unsigned long slotsCount;
+    unsigned long slotsCapacity;
 } SceneComponentData;
 
 typedef struct Scene
 {
     long generation;
+    // SCENE_FLAG_* bits
+    unsigned int flags;
+
+    // all memory of the scene is allocated through the allocator callbacks, or from the
+    // built-in arena if they are not set. The arena blocks are chained through their first bytes
+    SceneAllocator allocator;
+    char *arenaBlock;
+    unsigned long arenaBlockUsed;
+    unsigned long arenaBlockSize;
+    // the last arena allocation, which can be resized in place
+    char *arenaLast;
 
     SceneComponentData sceneComponentData[256];
 
-    SceneNodeId firstRoot, firstFree;
+    unsigned int firstFree;
+
+    // SceneNodeIds are mapped to node slots, so CompactScene can move nodes without
+    // invalidating them. The id arrays share nodeIdsCount and nodeIdsCapacity.
+    // nodeIdIndices holds the slot of a live id or the next released id after firstFreeId
+    unsigned int *nodeIdIndices;
+    // negated for released ids
+    long *nodeIdGenerations;
+    // the upper 32 bits of the id's SceneNodeHandle; 0 for released ids
+    unsigned int *nodeHandleTags;
+    unsigned int firstFreeId;
+    unsigned long nodeIdsCount;
+    unsigned long nodeIdsCapacity;
+
+    // all node arrays are indexed by the node slot and share nodesCount and nodesCapacity
     SceneNode *nodes;
+    // id of the node in the slot or SCENE_NODE_INDEX_NONE for free slots
+    unsigned int *nodeIds;
+    Vector3 *nodePositions;
+    // euler angles in degrees or a quaternion, depending on nodeRotationModes
+    Vector3 *nodeRotations;
+    Quaternion *nodeRotationsQ;
+    unsigned char *nodeRotationModes;
+    // SCENE_TRANSFORM_* kind of the local transform
+    unsigned char *nodeTransformKinds;
+    Vector3 *nodeScales;
+    // world matrices are always affine, so only the upper three rows are stored
+    SceneAffineMatrix *nodeLocalToWorld;
+    // index of the parent node or SCENE_NODE_INDEX_NONE for root nodes
+    unsigned int *nodeParents;
+    // index into models or -1 if the node has no model or is released
+    int *nodeModels;
+    // set when the node's or any ancestor's TRS changed since localToWorld was computed;
+    // a dirty node always has only dirty descendants, except below static nodes
+    char *nodeTRSDirty;
+    // set by SetSceneNodeStatic; static subtrees are left out of the hierarchy order
+    char *nodeStatic;
+    // set while the node is in changedNodes
+    char *nodeChanged;
+    // world space bounds of the node's model and of its whole subtree with the number of meshes
+    // in it; refit at the end of UpdateSceneTransforms
+    BoundingBox *nodeBounds;
+    BoundingBox *nodeSubtreeBounds;
+    unsigned int *nodeSubtreeMeshCounts;
+    // set when nodeSubtreeBounds needs a refit; all ancestors of a marked node are marked too
+    char *nodeSubtreeBoundsDirty;
+    // the node's leaf in dynamicBVH or SCENE_NODE_INDEX_NONE
+    unsigned int *nodeBVHLeaves;
+    // set while the node is in bvhDirtyNodes
+    char *nodeBVHDirty;
     unsigned long nodesCount;
     unsigned long nodesCapacity;
 
@@ -77,6 +273,70 @@ typedef struct Scene
     unsigned long modelsCount;
     unsigned long modelsCapacity;
 
+    // interned node names indexed by name id; id 0 stands for no name. The strings are
+    // stored in blocks that never move, each linking to the previous one in its first bytes
+    const char **names;
+    unsigned int *nameHashes;
+    unsigned int namesCount;
+    unsigned int namesCapacity;
+    // open addressing table of name ids by string; the capacity is a power of two
+    unsigned int *namesTable;
+    unsigned int namesTableCapacity;
+    char *nameBlock;
+    unsigned long nameBlockUsed;
+    unsigned long nameBlockSize;
+    // open addressing table of the named nodes by parent id and name id; every named node
+    // is listed under its parent and under SCENE_NAME_ANY_PARENT. Nodes sharing a key are
+    // chained through prevNamed and nextNamed and the entry holds the first of them
+    SceneNameIndexEntry *nameIndex;
+    unsigned long nameIndexCount;
+    unsigned long nameIndexCapacity;
+
+    // all live nodes in parent-before-child order; rebuilt when the hierarchy changes
+    SceneHierarchyEntry *hierarchyOrder;
+    unsigned long hierarchyOrderCount;
+    unsigned long hierarchyOrderCapacity;
+    // end offsets of the depth levels in hierarchyOrder; the breadth first order keeps every level contiguous
+    unsigned long *hierarchyLevelEnds;
+    unsigned long hierarchyLevelCount;
+    // scratch lists of the dirty nodes of a transform update and their level end offsets,
+    // same capacity as hierarchyOrder
+    unsigned int *dirtyNodes;
+    unsigned long *dirtyLevelEnds;
+    // all root nodes including static ones, same capacity as hierarchyOrder
+    unsigned int *rootNodes;
+    unsigned long rootNodesCount;
+    char isHierarchyOrderDirty;
+    // scratch list of the dirty ancestors of a single node brought up to date, top-down
+    unsigned int *dirtyChain;
+    unsigned long dirtyChainCapacity;
+
+    // ids of the roots of the subtrees marked for a bounds refit; ids may have gone stale since
+    unsigned int *boundsDirtyRoots;
+    unsigned long boundsDirtyRootsCount;
+    unsigned long boundsDirtyRootsCapacity;
+
+    // spatial index over the world bounds of the nodes with models: static subtrees are built
+    // into staticBVH when they change, all other nodes are kept in dynamicBVH
+    SceneBVH staticBVH;
+    SceneBVH dynamicBVH;
+    char isStaticBVHDirty;
+    // nodes with the static flag; without any, nodes can't be in static subtrees
+    unsigned long staticNodeCount;
+    // ids of the nodes whose leaves the next query brings up to date; ids may have gone stale since
+    unsigned int *bvhDirtyNodes;
+    unsigned long bvhDirtyNodesCount;
+    unsigned long bvhDirtyNodesCapacity;
+    // traversal stack of the queries, large enough for either tree
+    SceneBVHStackEntry *bvhStack;
+    unsigned long bvhStackCapacity;
+
+    // handles of the nodes whose world transform was recomputed since the last
+    // ClearSceneChangedNodes; only recorded with SCENE_FLAG_RECORD_CHANGES
+    SceneNodeHandle *changedNodes;
+    unsigned long changedNodesCount;
+    unsigned long changedNodesCapacity;
+
 } Scene;
 
 static Scene *scenes = 0;
@@ -96,10 +356,217 @@ void RegisterSceneNodeComponent(SceneNodeComponentDefinition definition)
     sceneNodeComponentDefinitions[index] = definition;
 }
 
-static SceneNode *GetSceneNode(SceneNodeId sceneNodeId, Scene **sceneOut);
+static SceneNode *GetSceneNode(SceneNodeId sceneNodeId, Scene **sceneOut, unsigned int *indexOut);
+static void StopSceneWorkerPool(void);
+static void RemoveSceneComponent(Scene *scene, unsigned char definitionId, unsigned int slot);
+static void BakeSceneNodeTree(Scene *scene, unsigned int index);
+static int IsSceneNodeInStaticTree(Scene *scene, unsigned int index);
+
+// # Scene memory
+
+// arena blocks start with the link to the previous block, padded to keep allocations aligned
+#define SCENE_ARENA_BLOCK_HEADER 16
+#define SCENE_ARENA_ALIGNMENT 16
+
+static void *AllocateSceneArena(Scene *scene, unsigned long size)
+{
+    size = (size + SCENE_ARENA_ALIGNMENT - 1) & ~(unsigned long)(SCENE_ARENA_ALIGNMENT - 1);
+    if (!scene->arenaBlock || scene->arenaBlockUsed + size > scene->arenaBlockSize)
+    {
+        // requests larger than the arena size get a block of their own
+        unsigned long blockSize = SCENE_ARENA_BLOCK_HEADER + size;
+        if (blockSize < scene->allocator.arenaSize)
+        {
+            blockSize = scene->allocator.arenaSize;
+        }
+        char *block;
+        if (!scene->arenaBlock && scene->allocator.arenaMemory && blockSize == scene->allocator.arenaSize)
+        {
+            block = scene->allocator.arenaMemory;
+        }
+        else
+        {
+            block = MemAlloc(blockSize);
+        }
+        memcpy(block, &scene->arenaBlock, sizeof(char *));
+        scene->arenaBlock = block;
+        scene->arenaBlockUsed = SCENE_ARENA_BLOCK_HEADER;
+        scene->arenaBlockSize = blockSize;
+    }
+
+    scene->arenaLast = scene->arenaBlock + scene->arenaBlockUsed;
+    scene->arenaBlockUsed += size;
+    return scene->arenaLast;
+}
+
+static void *AllocateSceneMemory(Scene *scene, unsigned long size)
+{
+    if (!scene->allocator.allocate)
+    {
+        return AllocateSceneArena(scene, size);
+    }
+
+    return scene->allocator.allocate(scene->allocator.userData, size);
+}
+
+static void ReleaseSceneMemory(Scene *scene, void *memory)
+{
+    if (!memory)
+    {
+        return;
+    }
+
+    if (scene->allocator.release)
+    {
+        scene->allocator.release(scene->allocator.userData, memory);
+    }
+    else if (memory == scene->arenaLast)
+    {
+        // only the last arena allocation is given back; everything else is freed with the scene
+        scene->arenaBlockUsed = (unsigned long)(scene->arenaLast - scene->arenaBlock);
+        scene->arenaLast = 0;
+    }
+}
+
+// oldSize is the size the array was allocated with; it is only needed by the arena
+static void *ResizeSceneArray(Scene *scene, void *array, unsigned long oldSize, unsigned long size)
+{
+    if (!array)
+    {
+        return AllocateSceneMemory(scene, size);
+    }
+
+    if (scene->allocator.reallocate)
+    {
+        return scene->allocator.reallocate(scene->allocator.userData, array, size);
+    }
+
+    if (array == scene->arenaLast)
+    {
+        unsigned long offset = (unsigned long)(scene->arenaLast - scene->arenaBlock);
+        unsigned long alignedSize = (size + SCENE_ARENA_ALIGNMENT - 1) & ~(unsigned long)(SCENE_ARENA_ALIGNMENT - 1);
+        if (offset + alignedSize <= scene->arenaBlockSize)
+        {
+            scene->arenaBlockUsed = offset + alignedSize;
+            return array;
+        }
+    }
+
+    void *resized = AllocateSceneArena(scene, size);
+    memcpy(resized, array, oldSize < size ? oldSize : size);
+    return resized;
+}
+
+static void *ListAlloc(Scene *scene, void **list, unsigned long *count, unsigned long *capacity, unsigned long size)
+{
+    if (*count >= *capacity)
+    {
+        unsigned long oldCapacity = *capacity;
+        *capacity = (*capacity == 0) ? 8 : *capacity * 2;
+        *list = ResizeSceneArray(scene, *list, oldCapacity * size, *capacity * size);
+    }
+    char *byteList = (char *)*list;
+    char *ptr = &byteList[*count * size];
+    *count += 1;
+    memset(ptr, 0, size);
+    return (void *)ptr;
+}
+
+static void *AllocateSceneMemoryDefault(void *userData, unsigned long size)
+{
+    return MemAlloc(size);
+}
+
+static void *ReallocateSceneMemoryDefault(void *userData, void *memory, unsigned long size)
+{
+    return MemRealloc(memory, size);
+}
+
+static void ReleaseSceneMemoryDefault(void *userData, void *memory)
+{
+    MemFree(memory);
+}
+
+static void FreeSceneNodeArrays(Scene *scene)
+{
+    if (scene->nodes)
+    {
+        ReleaseSceneMemory(scene, scene->nodes);
+        ReleaseSceneMemory(scene, scene->nodeIds);
+        ReleaseSceneMemory(scene, scene->nodePositions);
+        ReleaseSceneMemory(scene, scene->nodeRotations);
+        ReleaseSceneMemory(scene, scene->nodeRotationsQ);
+        ReleaseSceneMemory(scene, scene->nodeRotationModes);
+        ReleaseSceneMemory(scene, scene->nodeTransformKinds);
+        ReleaseSceneMemory(scene, scene->nodeScales);
+        ReleaseSceneMemory(scene, scene->nodeLocalToWorld);
+        ReleaseSceneMemory(scene, scene->nodeParents);
+        ReleaseSceneMemory(scene, scene->nodeModels);
+        ReleaseSceneMemory(scene, scene->nodeTRSDirty);
+        ReleaseSceneMemory(scene, scene->nodeStatic);
+        ReleaseSceneMemory(scene, scene->nodeChanged);
+        ReleaseSceneMemory(scene, scene->nodeBounds);
+        ReleaseSceneMemory(scene, scene->nodeSubtreeBounds);
+        ReleaseSceneMemory(scene, scene->nodeSubtreeMeshCounts);
+        ReleaseSceneMemory(scene, scene->nodeSubtreeBoundsDirty);
+        ReleaseSceneMemory(scene, scene->nodeBVHLeaves);
+        ReleaseSceneMemory(scene, scene->nodeBVHDirty);
+    }
+    // the arrays are allocated again by ResizeSceneNodeArrays when nodes are acquired
+    scene->nodes = 0;
+    scene->nodeIds = 0;
+    scene->nodePositions = 0;
+    scene->nodeRotations = 0;
+    scene->nodeRotationsQ = 0;
+    scene->nodeRotationModes = 0;
+    scene->nodeTransformKinds = 0;
+    scene->nodeScales = 0;
+    scene->nodeLocalToWorld = 0;
+    scene->nodeParents = 0;
+    scene->nodeModels = 0;
+    scene->nodeTRSDirty = 0;
+    scene->nodeStatic = 0;
+    scene->nodeChanged = 0;
+    scene->nodeBounds = 0;
+    scene->nodeSubtreeBounds = 0;
+    scene->nodeSubtreeMeshCounts = 0;
+    scene->nodeSubtreeBoundsDirty = 0;
+    scene->nodeBVHLeaves = 0;
+    scene->nodeBVHDirty = 0;
+    scene->nodesCount = 0;
+    scene->nodesCapacity = 0;
+    scene->firstFree = SCENE_NODE_INDEX_NONE;
+}
+
+static void FreeSceneHierarchyOrder(Scene *scene)
+{
+    if (scene->hierarchyOrder)
+    {
+        ReleaseSceneMemory(scene, scene->hierarchyOrder);
+        ReleaseSceneMemory(scene, scene->hierarchyLevelEnds);
+        ReleaseSceneMemory(scene, scene->dirtyNodes);
+        ReleaseSceneMemory(scene, scene->dirtyLevelEnds);
+        ReleaseSceneMemory(scene, scene->rootNodes);
+        scene->hierarchyOrder = 0;
+        scene->hierarchyLevelEnds = 0;
+        scene->dirtyNodes = 0;
+        scene->dirtyLevelEnds = 0;
+        scene->rootNodes = 0;
+    }
+    scene->rootNodesCount = 0;
+    scene->hierarchyOrderCount = 0;
+    scene->hierarchyOrderCapacity = 0;
+    scene->hierarchyLevelCount = 0;
+    scene->isHierarchyOrderDirty = 1;
+}
 
 // # Scene Management Functions
 SceneId LoadScene()
+{
+    return LoadSceneEx((SceneAllocator){0});
+}
+
+SceneId LoadSceneEx(SceneAllocator allocator)
 {
     int useIndex = -1;
     for (unsigned long i = 0; i < scenesCount; i++)
@@ -113,16 +580,51 @@ SceneId LoadScene()
 
     if (useIndex == -1)
     {
+        if (scenesCount >= SCENE_MAX_SCENE_COUNT)
+        {
+            TraceLog(LOG_WARNING, "LoadScene: can't have more than %d scenes loaded at once", SCENE_MAX_SCENE_COUNT);
+            return (SceneId){0};
+        }
+
         scenes = scenes ? MemRealloc(scenes, sizeof(Scene) * (scenesCount + 1)) : MemAlloc(sizeof(Scene));
         useIndex = scenesCount;
         scenesCount++;
+        // MemRealloc leaves the new slot uninitialized
+        scenes[useIndex].generation = 0;
     }
 
     SceneId sceneId = {useIndex, scenes[useIndex].generation};
     sceneId.generation = -sceneId.generation + 1;
 
+    if (!allocator.allocate || !allocator.reallocate || !allocator.release)
+    {
+        if ((allocator.allocate || allocator.reallocate || allocator.release))
+        {
+            TraceLog(LOG_WARNING, "LoadSceneEx: allocator callbacks must be set all together, using the default allocator");
+        }
+        allocator.allocate = 0;
+        allocator.reallocate = 0;
+        allocator.release = 0;
+        if (allocator.arenaSize == 0)
+        {
+            allocator.allocate = AllocateSceneMemoryDefault;
+            allocator.reallocate = ReallocateSceneMemoryDefault;
+            allocator.release = ReleaseSceneMemoryDefault;
+        }
+    }
+    if ((size_t)allocator.arenaMemory % SCENE_ARENA_ALIGNMENT != 0)
+    {
+        TraceLog(LOG_WARNING, "LoadSceneEx: arena memory must be aligned to %d bytes, allocating the arena instead", SCENE_ARENA_ALIGNMENT);
+        allocator.arenaMemory = 0;
+    }
+
     scenes[useIndex] = (Scene){
-        .generation = sceneId.generation};
+        .generation = sceneId.generation,
+        .allocator = allocator,
+        .firstFree = SCENE_NODE_INDEX_NONE,
+        .firstFreeId = SCENE_NODE_INDEX_NONE,
+        .staticBVH = {.root = SCENE_NODE_INDEX_NONE, .firstFree = SCENE_NODE_INDEX_NONE},
+        .dynamicBVH = {.root = SCENE_NODE_INDEX_NONE, .firstFree = SCENE_NODE_INDEX_NONE}};
 
     return sceneId;
 }
@@ -134,15 +636,35 @@ void UnloadScene(SceneId sceneId)
         return;
     }
 
+    // components get their onRemove call while their nodes are still valid
+    Scene *scene = &scenes[sceneId.id];
+    for (int definitionId = 0; definitionId < 256; definitionId++)
+    {
+        SceneComponentData *pool = &scene->sceneComponentData[definitionId];
+        while (pool->count > 0)
+        {
+            RemoveSceneComponent(scene, (unsigned char)definitionId, pool->componentSlots[pool->count - 1]);
+        }
+        if (pool->slotIndices)
+        {
+            ReleaseSceneMemory(scene, pool->componentData);
+            ReleaseSceneMemory(scene, pool->componentNodeIds);
+            ReleaseSceneMemory(scene, pool->componentSlots);
+            ReleaseSceneMemory(scene, pool->slotIndices);
+            ReleaseSceneMemory(scene, pool->slotGenerations);
+            ReleaseSceneMemory(scene, pool->slotNextOfNode);
+            *pool = (SceneComponentData){0};
+        }
+    }
+
     scenes[sceneId.id].generation = -scenes[sceneId.id].generation;
 
-    Scene *scene = &scenes[sceneId.id];
     // Unload all scene resources
     for (int i = 0; i < scene->modelsCount; i++)
     {
         SceneModel *sceneModel = &scene->models[i];
-        MemFree(sceneModel->meshBounds);
-        MemFree(sceneModel->meshBoundingSpheres);
+        ReleaseSceneMemory(scene, sceneModel->meshBounds);
+        ReleaseSceneMemory(scene, sceneModel->meshBoundingSpheres);
         sceneModel->meshBounds = 0;
         sceneModel->meshBoundingSpheres = 0;
 
@@ -156,24 +678,89 @@ void UnloadScene(SceneId sceneId)
 
     if (scene->models)
     {
-        MemFree(scene->models);
+        ReleaseSceneMemory(scene, scene->models);
         scene->models = 0;
     }
 
-    for (int i = 0; i < scene->nodesCount; i++)
+    while (scene->nameBlock)
     {
-        SceneNode *node = &scene->nodes[i];
-        if (node->generation < 0)
-        {
-            continue;
-        }
+        char *previousBlock;
+        memcpy(&previousBlock, scene->nameBlock, sizeof(char *));
+        ReleaseSceneMemory(scene, scene->nameBlock);
+        scene->nameBlock = previousBlock;
+    }
+    if (scene->names)
+    {
+        ReleaseSceneMemory(scene, scene->names);
+        ReleaseSceneMemory(scene, scene->nameHashes);
+        ReleaseSceneMemory(scene, scene->namesTable);
+        scene->names = 0;
+    }
+    if (scene->nameIndex)
+    {
+        ReleaseSceneMemory(scene, scene->nameIndex);
+        scene->nameIndex = 0;
+    }
+
+    FreeSceneNodeArrays(scene);
+    FreeSceneHierarchyOrder(scene);
+
+    if (scene->nodeIdIndices)
+    {
+        ReleaseSceneMemory(scene, scene->nodeIdIndices);
+        ReleaseSceneMemory(scene, scene->nodeIdGenerations);
+        ReleaseSceneMemory(scene, scene->nodeHandleTags);
+        scene->nodeIdIndices = 0;
+    }
+    // ids and handles are validated against nodeIdsCount, so this invalidates all of them
+    scene->nodeIdsCount = 0;
+    scene->nodeIdsCapacity = 0;
+
+    if (scene->changedNodes)
+    {
+        ReleaseSceneMemory(scene, scene->changedNodes);
+        scene->changedNodes = 0;
+    }
+    if (scene->boundsDirtyRoots)
+    {
+        ReleaseSceneMemory(scene, scene->boundsDirtyRoots);
+        scene->boundsDirtyRoots = 0;
+    }
+    if (scene->dirtyChain)
+    {
+        ReleaseSceneMemory(scene, scene->dirtyChain);
+        scene->dirtyChain = 0;
+    }
+    scene->dirtyChainCapacity = 0;
+    scene->boundsDirtyRootsCount = 0;
+    scene->boundsDirtyRootsCapacity = 0;
+    ReleaseSceneMemory(scene, scene->staticBVH.nodes);
+    ReleaseSceneMemory(scene, scene->dynamicBVH.nodes);
+    ReleaseSceneMemory(scene, scene->bvhDirtyNodes);
+    ReleaseSceneMemory(scene, scene->bvhStack);
+    scene->staticBVH = (SceneBVH){.root = SCENE_NODE_INDEX_NONE, .firstFree = SCENE_NODE_INDEX_NONE};
+    scene->dynamicBVH = (SceneBVH){.root = SCENE_NODE_INDEX_NONE, .firstFree = SCENE_NODE_INDEX_NONE};
+    scene->bvhDirtyNodes = 0;
+    scene->bvhDirtyNodesCount = 0;
+    scene->bvhDirtyNodesCapacity = 0;
+    scene->bvhStack = 0;
+    scene->bvhStackCapacity = 0;
+    scene->isStaticBVHDirty = 0;
+    scene->staticNodeCount = 0;
 
-        if (node->name)
+    // the arena is released in a few frees, no matter how many allocations it served;
+    // the caller's arena memory is left alone
+    while (scene->arenaBlock)
+    {
+        char *previousBlock;
+        memcpy(&previousBlock, scene->arenaBlock, sizeof(char *));
+        if (scene->arenaBlock != scene->allocator.arenaMemory)
         {
-            MemFree(node->name);
-            node->name = 0;
+            MemFree(scene->arenaBlock);
         }
+        scene->arenaBlock = previousBlock;
     }
+    scene->arenaLast = 0;
 
     // clean up all when last scene is unloaded
     for (unsigned long i = 0; i < scenesCount; i++)
@@ -188,6 +775,7 @@ void UnloadScene(SceneId sceneId)
     MemFree(scenes);
     scenes = 0;
     scenesCount = 0;
+    StopSceneWorkerPool();
 }
 
 int IsSceneValid(SceneId sceneId)
@@ -196,59 +784,69 @@ int IsSceneValid(SceneId sceneId)
 }
 
 
-static Vector3 Vector4Transform3(Vector4 v, Matrix m)
+static Matrix AffineToMatrix(SceneAffineMatrix affine)
 {
-    Vector4 result = { 0 };
-    result.x = v.x*m.m0 + v.y*m.m4 + v.z*m.m8 + v.w*m.m12;
-    result.y = v.x*m.m1 + v.y*m.m5 + v.z*m.m9 + v.w*m.m13;
-    result.z = v.x*m.m2 + v.y*m.m6 + v.z*m.m10 + v.w*m.m14;
-    result.w = v.x*m.m3 + v.y*m.m7 + v.z*m.m11 + v.w*m.m15;
-    return (Vector3){result.x / result.w, result.y / result.w, result.z / result.w};
+    return (Matrix){
+        affine.m0, affine.m4, affine.m8, affine.m12,
+        affine.m1, affine.m5, affine.m9, affine.m13,
+        affine.m2, affine.m6, affine.m10, affine.m14,
+        0.0f, 0.0f, 0.0f, 1.0f};
 }
 
-static void CalcFrustumCorners(Camera3D camera, Vector3* corners)
+Matrix GetSceneViewProjection(SceneDrawConfig config)
 {
-    Matrix view = GetCameraMatrix(camera);
-    Matrix proj = MatrixIdentity();
-    proj = MatrixPerspective(camera.fovy * DEG2RAD, (double)GetScreenWidth() / (double)GetScreenHeight(), 1.0f, 30.0f);
-    Matrix viewProj = MatrixMultiply(view, proj);
-    viewProj = MatrixInvert(viewProj);
-    corners[0] = Vector4Transform3((Vector4){-1, -1, -1, 1}, viewProj);
-    corners[1] = Vector4Transform3((Vector4){1, -1, -1, 1}, viewProj);
-    corners[2] = Vector4Transform3((Vector4){1, 1, -1, 1}, viewProj);
-    corners[3] = Vector4Transform3((Vector4){-1, 1, -1, 1}, viewProj);
-    corners[4] = Vector4Transform3((Vector4){-1, -1, 1, 1}, viewProj);
-    corners[5] = Vector4Transform3((Vector4){1, -1, 1, 1}, viewProj);
-    corners[6] = Vector4Transform3((Vector4){1, 1, 1, 1}, viewProj);
-    corners[7] = Vector4Transform3((Vector4){-1, 1, 1, 1}, viewProj);
+    Camera3D camera = config.camera;
+    float nearPlane = config.nearPlane > 0.0f ? config.nearPlane : RL_CULL_DISTANCE_NEAR;
+    float farPlane = config.farPlane > 0.0f ? config.farPlane : RL_CULL_DISTANCE_FAR;
+    float aspect = config.aspect;
+    if (aspect <= 0.0f)
+    {
+        // BeginMode3D uses the size of the current render target, which isn't exposed;
+        // without a window, there's no screen to take it from either
+        int screenHeight = GetScreenHeight();
+        aspect = screenHeight > 0 ? (float)GetScreenWidth() / (float)screenHeight : 1.0f;
+    }
+
+    Matrix projection;
+    if (camera.projection == CAMERA_ORTHOGRAPHIC)
+    {
+        double top = camera.fovy / 2.0;
+        double right = top * aspect;
+        projection = MatrixOrtho(-right, right, -top, top, nearPlane, farPlane);
+    }
+    else
+    {
+        projection = MatrixPerspective(camera.fovy * DEG2RAD, aspect, nearPlane, farPlane);
+    }
+
+    return MatrixMultiply(GetCameraMatrix(camera), projection);
 }
 
-static void GetCameraFrustumPlanes(Camera3D camera, Vector4 *planes)
+void GetSceneFrustumPlanes(Matrix viewProjection, Vector4 *planes)
 {
-    // this algorithm is absolutely nowhere near optimal, but I am able
-    // to understand it and it works; it can be optimized later
-    Vector3 corners[8];
-    CalcFrustumCorners(camera, corners);
-    Vector3 nearCenter = Vector3Scale(Vector3Add(corners[0], corners[2]), 0.5f);
-    Vector3 farCenter = Vector3Scale(Vector3Add(corners[4], corners[6]), 0.5f);
-    Vector3 rightCenter = Vector3Scale(Vector3Add(corners[1], corners[6]), 0.5f);
-    Vector3 leftCenter = Vector3Scale(Vector3Add(corners[0], corners[7]), 0.5f);
-    Vector3 topCenter = Vector3Scale(Vector3Add(corners[2], corners[7]), 0.5f);
-    Vector3 bottomCenter = Vector3Scale(Vector3Add(corners[0], corners[5]), 0.5f);
-
-    Vector3 nearCenterNormal = Vector3Normalize(Vector3Subtract(nearCenter, camera.position));
-    Vector3 farCenterNormal = Vector3Scale(nearCenterNormal, -1.0f);
-    Vector3 rightCenterNormal = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(corners[2], corners[1]), Vector3Subtract(corners[6], corners[2])));
-    Vector3 leftCenterNormal = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(corners[3], corners[0]), Vector3Subtract(corners[0], corners[4])));
-    Vector3 topCenterNormal = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(corners[3], corners[2]), Vector3Subtract(corners[7], corners[3])));
-    Vector3 bottomCenterNormal = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(corners[1], corners[0]), Vector3Subtract(corners[5], corners[1])));
+    // a point is inside when its clip coordinates satisfy -w <= x, y, z <= w, so every plane
+    // is the sum or the difference of the w row and another row of the matrix (Gribb/Hartmann)
+    Matrix m = viewProjection;
+    const float rows[4][4] = {
+        {m.m0, m.m4, m.m8, m.m12},
+        {m.m1, m.m5, m.m9, m.m13},
+        {m.m2, m.m6, m.m10, m.m14},
+        {m.m3, m.m7, m.m11, m.m15}};
+    // row and sign of the near, far, right, left, top and bottom planes
+    const int planeRows[6] = {2, 2, 0, 0, 1, 1};
+    const float planeSigns[6] = {1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f};
+    for (int i = 0; i < 6; i++)
+    {
+        const float *row = rows[planeRows[i]];
+        float x = rows[3][0] + planeSigns[i] * row[0];
+        float y = rows[3][1] + planeSigns[i] * row[1];
+        float z = rows[3][2] + planeSigns[i] * row[2];
+        float w = rows[3][3] + planeSigns[i] * row[3];
 
-    planes[0] = (Vector4){nearCenterNormal.x, nearCenterNormal.y, nearCenterNormal.z, Vector3DotProduct(nearCenter, nearCenterNormal)};
-    planes[1] = (Vector4){farCenterNormal.x, farCenterNormal.y, farCenterNormal.z, Vector3DotProduct(farCenter, farCenterNormal)};
-    planes[2] = (Vector4){rightCenterNormal.x, rightCenterNormal.y, rightCenterNormal.z, Vector3DotProduct(rightCenter, rightCenterNormal)};
-    planes[3] = (Vector4){leftCenterNormal.x, leftCenterNormal.y, leftCenterNormal.z, Vector3DotProduct(leftCenter, leftCenterNormal)};
-    planes[4] = (Vector4){topCenterNormal.x, topCenterNormal.y, topCenterNormal.z, Vector3DotProduct(topCenter, topCenterNormal)};
-    planes[5] = (Vector4){bottomCenterNormal.x, bottomCenterNormal.y, bottomCenterNormal.z, Vector3DotProduct(bottomCenter, bottomCenterNormal)};
+        // normalized to the normal and distance form
+        float length = sqrtf(x * x + y * y + z * z);
+        planes[i] = (Vector4){x / length, y / length, z / length, -w / length};
+    }
 }
 
 static void DrawPlaneEq(Vector4 planeEq, Color color)
@@ -265,132 +863,423 @@ static void DrawPlaneEq(Vector4 planeEq, Color color)
 
 int CheckCollisionBoxFrustum(BoundingBox box, Vector4 *planes, Matrix transform)
 {
-    Vector3 corners[8] = {
-        (Vector3){box.min.x, box.min.y, box.min.z},
-        (Vector3){box.max.x, box.min.y, box.min.z},
-        (Vector3){box.max.x, box.max.y, box.min.z},
-        (Vector3){box.min.x, box.max.y, box.min.z},
-        (Vector3){box.min.x, box.min.y, box.max.z},
-        (Vector3){box.max.x, box.min.y, box.max.z},
-        (Vector3){box.max.x, box.max.y, box.max.z},
-        (Vector3){box.min.x, box.max.y, box.max.z}};
-    for (int i = 0; i < 8; i++)
+    // the box is outside if it's entirely behind one of the planes: its center is further
+    // behind than the box reaches along the plane normal
+    Vector3 center = Vector3Transform(Vector3Scale(Vector3Add(box.min, box.max), 0.5f), transform);
+    Vector3 extent = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+    for (int i = 0; i < 6; i++)
     {
-        corners[i] = Vector3Transform(corners[i], transform);
+        Vector4 plane = planes[i];
+        float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z - plane.w;
+        float reach = extent.x * fabsf(plane.x * transform.m0 + plane.y * transform.m1 + plane.z * transform.m2) +
+            extent.y * fabsf(plane.x * transform.m4 + plane.y * transform.m5 + plane.z * transform.m6) +
+            extent.z * fabsf(plane.x * transform.m8 + plane.y * transform.m9 + plane.z * transform.m10);
+        if (distance + reach < 0.0f)
+        {
+            return 0;
+        }
     }
 
-    for (int i = 0; i < 6; i++)
+    return 1;
+}
+
+// the kernel of CullSceneBoxes; with insideFlags given, it also sets insideFlags[k] for the
+// visible box visibleIndices[k] if the box is entirely in front of all planes
+static unsigned long ClassifySceneBoxes(SceneBoxArrays boxes, unsigned long count, Vector4 *planes, unsigned int *visibleIndices, unsigned char *insideFlags)
+{
+    // the same test as CheckCollisionBoxFrustum, with the reach along each plane normal
+    // computed from the absolute normal since the boxes are in world space
+    float absPlanes[6][3];
+    for (int p = 0; p < 6; p++)
+    {
+        absPlanes[p][0] = fabsf(planes[p].x);
+        absPlanes[p][1] = fabsf(planes[p].y);
+        absPlanes[p][2] = fabsf(planes[p].z);
+    }
+
+    unsigned long visibleCount = 0;
+    unsigned long i = 0;
+#if defined(SCENE_SIMD_WIDTH)
+    SceneFloatV normals[6][3], absNormals[6][3], distances[6];
+    for (int p = 0; p < 6; p++)
     {
-        int out = 0;
-        Vector3 planeCenter = Vector3Scale((Vector3){planes[i].x, planes[i].y, planes[i].z}, planes[i].w);
-        Vector3 planeNormal = (Vector3){planes[i].x, planes[i].y, planes[i].z};
-        for (int j = 0; j < 8; j++)
+        normals[p][0] = SimdSet1(planes[p].x);
+        normals[p][1] = SimdSet1(planes[p].y);
+        normals[p][2] = SimdSet1(planes[p].z);
+        absNormals[p][0] = SimdSet1(absPlanes[p][0]);
+        absNormals[p][1] = SimdSet1(absPlanes[p][1]);
+        absNormals[p][2] = SimdSet1(absPlanes[p][2]);
+        distances[p] = SimdSet1(planes[p].w);
+    }
+
+    for (; i + SCENE_SIMD_WIDTH <= count; i += SCENE_SIMD_WIDTH)
+    {
+        SceneFloatV cx = SimdLoad(boxes.centerX + i), cy = SimdLoad(boxes.centerY + i), cz = SimdLoad(boxes.centerZ + i);
+        SceneFloatV ex = SimdLoad(boxes.extentX + i), ey = SimdLoad(boxes.extentY + i), ez = SimdLoad(boxes.extentZ + i);
+        int mask = (1 << SCENE_SIMD_WIDTH) - 1;
+        int insideMask = mask;
+        for (int p = 0; p < 6; p++)
         {
-            Vector3 relative = Vector3Subtract(corners[j], planeCenter);
-            if (Vector3DotProduct(planeNormal, relative) < 0)
+            // dot(normal, center) + reach >= w for boxes not entirely behind the plane,
+            // and dot(normal, center) - reach >= w for those entirely in front of it
+            SceneFloatV side = SimdAdd(SimdAdd(SimdMul(normals[p][0], cx), SimdMul(normals[p][1], cy)), SimdMul(normals[p][2], cz));
+            SceneFloatV reach = SimdAdd(SimdAdd(SimdMul(absNormals[p][0], ex), SimdMul(absNormals[p][1], ey)), SimdMul(absNormals[p][2], ez));
+            mask &= SimdMoveMask(SimdCmpGe(SimdAdd(side, reach), distances[p]));
+            if (insideFlags)
             {
-                // DrawLine3D(corners[j], planeCenter, BLUE);
-                // Vector3 planeNormal = Vector3Normalize((Vector3){planes[i].x, planes[i].y, planes[i].z});
-                // DrawLine3D(planeCenter, Vector3Add(planeCenter, planeNormal), RED);
-                out++;
+                insideMask &= SimdMoveMask(SimdCmpGe(SimdSub(side, reach), distances[p]));
             }
-            else
+        }
+
+        // every lane is written and the count only advances for visible ones, which avoids
+        // branching on the visibility; the writes never pass index i + lane
+        for (int j = 0; j < SCENE_SIMD_WIDTH; j++)
+        {
+            visibleIndices[visibleCount] = (unsigned int)(i + j);
+            if (insideFlags)
             {
-                break;
+                insideFlags[visibleCount] = (unsigned char)((insideMask >> j) & 1);
             }
+            visibleCount += (mask >> j) & 1;
         }
-
-        if (out == 8)
+    }
+#endif
+    for (; i < count; i++)
+    {
+        int visible = 1;
+        int inside = 1;
+        for (int p = 0; p < 6 && visible; p++)
         {
-            return 0;
+            float side = planes[p].x * boxes.centerX[i] + planes[p].y * boxes.centerY[i] + planes[p].z * boxes.centerZ[i];
+            float reach = absPlanes[p][0] * boxes.extentX[i] + absPlanes[p][1] * boxes.extentY[i] + absPlanes[p][2] * boxes.extentZ[i];
+            visible = side + reach >= planes[p].w;
+            inside = inside && side - reach >= planes[p].w;
         }
+        visibleIndices[visibleCount] = (unsigned int)i;
+        if (insideFlags)
+        {
+            insideFlags[visibleCount] = (unsigned char)inside;
+        }
+        visibleCount += visible;
     }
 
-    return 1;
+    return visibleCount;
 }
 
-SceneDrawStats DrawScene(SceneId sceneId, SceneDrawConfig config)
+unsigned long CullSceneBoxes(SceneBoxArrays boxes, unsigned long count, Vector4 *planes, unsigned int *visibleIndices)
 {
-    SceneDrawStats stats = {0};
-    if (!IsSceneValid(sceneId))
+    return ClassifySceneBoxes(boxes, count, planes, visibleIndices, 0);
+}
+
+#define SCENE_CULL_OUTSIDE 0
+#define SCENE_CULL_INSIDE 1
+#define SCENE_CULL_INTERSECTING 2
+
+// classifies the bounding sphere, transformed by the matrix, against the planes; maxScale is the
+// largest scale of the transform's axes
+static int CheckSceneSphereFrustum(Vector4 sphere, Vector4 *planes, Matrix transform, float maxScale)
+{
+    Vector3 center = Vector3Transform((Vector3){sphere.x, sphere.y, sphere.z}, transform);
+    float radius = sphere.w * maxScale;
+    int result = SCENE_CULL_INSIDE;
+    for (int i = 0; i < 6; i++)
     {
-        return stats;
+        float distance = planes[i].x * center.x + planes[i].y * center.y + planes[i].z * center.z - planes[i].w;
+        if (distance < -radius)
+        {
+            return SCENE_CULL_OUTSIDE;
+        }
+        if (distance < radius)
+        {
+            result = SCENE_CULL_INTERSECTING;
+        }
     }
 
-    Camera3D camera = config.camera; 
-    Matrix transform = config.transform;
-    unsigned long layerMask = config.layerMask;
-    int sortMode = config.sortMode;
-    char drawBoundingBoxes = config.drawBoundingBoxes;
+    return result;
+}
 
-    Vector4 frustumPlanes[6];
-    GetCameraFrustumPlanes(camera, frustumPlanes);
+// an upper bound of how much the matrix stretches any vector
+static float GetSceneMatrixMaxScale(Matrix m)
+{
+    Vector3 x = {m.m0, m.m1, m.m2};
+    Vector3 y = {m.m4, m.m5, m.m6};
+    Vector3 z = {m.m8, m.m9, m.m10};
+    float xx = Vector3DotProduct(x, x), yy = Vector3DotProduct(y, y), zz = Vector3DotProduct(z, z);
 
-    if (config.drawCameraFrustum)
+    // the longest axis is only exact for orthogonal axes; a parent's non-uniform scale shears
+    // rotated children, and then the sum of all axes still bounds the stretch
+    float tolerance = 1e-4f * (xx + yy + zz);
+    if (fabsf(Vector3DotProduct(x, y)) > tolerance || fabsf(Vector3DotProduct(x, z)) > tolerance || fabsf(Vector3DotProduct(y, z)) > tolerance)
     {
-        DrawPlaneEq(frustumPlanes[0], GREEN);
-        DrawPlaneEq(frustumPlanes[1], GREEN);
-        DrawPlaneEq(frustumPlanes[2], GREEN);
-        DrawPlaneEq(frustumPlanes[3], GREEN);
-        DrawPlaneEq(frustumPlanes[4], GREEN);
-        DrawPlaneEq(frustumPlanes[5], GREEN);
+        return sqrtf(xx + yy + zz);
     }
 
+    return sqrtf(fmaxf(fmaxf(xx, yy), zz));
+}
 
-    Scene *scene = &scenes[sceneId.id];
-    for (int i = 0; i < scene->nodesCount; i++)
+// classifies the world space box against the planes
+static int CheckSceneBoundsFrustum(BoundingBox box, Vector4 *planes)
+{
+    Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+    Vector3 extent = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+    int result = SCENE_CULL_INSIDE;
+    for (int i = 0; i < 6; i++)
     {
-        SceneNode *node = &scene->nodes[i];
-        if (node->generation < 0)
+        Vector4 plane = planes[i];
+        float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z - plane.w;
+        float reach = extent.x * fabsf(plane.x) + extent.y * fabsf(plane.y) + extent.z * fabsf(plane.z);
+        if (distance + reach < 0.0f)
         {
-            continue;
+            return SCENE_CULL_OUTSIDE;
         }
-
-        SceneModel *sceneModel = &scene->models[node->model.id];
-        if (sceneModel->generation != node->model.generation)
+        if (distance - reach < 0.0f)
         {
-            continue;
+            result = SCENE_CULL_INTERSECTING;
         }
+    }
 
-        Matrix matrix = GetSceneNodeLocalTransform((SceneNodeId){sceneId, i, node->generation});
-        Model model = sceneModel->model;
-        for (int i = 0; i < model.meshCount; i++)
-        {
-            BoundingBox box = sceneModel->meshBounds[i];
-            if (!CheckCollisionBoxFrustum(box, frustumPlanes, matrix))
-            {
-                stats.culledMeshCount++;
-                continue;
-            }
-
-            Color color = model.materials[model.meshMaterial[i]].maps[MATERIAL_MAP_DIFFUSE].color;
+    return result;
+}
 
-            Color colorTint = WHITE;
-            model.materials[model.meshMaterial[i]].maps[MATERIAL_MAP_DIFFUSE].color = colorTint;
-            DrawMesh(model.meshes[i], model.materials[model.meshMaterial[i]], matrix);
-            model.materials[model.meshMaterial[i]].maps[MATERIAL_MAP_DIFFUSE].color = color;
+// draws the meshes of the node's model; with testMeshes set, each mesh is culled on its own
+static void DrawSceneNodeMeshes(Scene *scene, unsigned int index, Vector4 *frustumPlanes, int testMeshes, SceneDrawStats *stats)
+{
+    if (scene->nodeModels[index] < 0)
+    {
+        return;
+    }
 
-            stats.meshDrawCount++;
-            stats.trianglesDrawCount += model.meshes[i].vertexCount / 3;
-        }
+    SceneModel *sceneModel = &scene->models[scene->nodeModels[index]];
+    Matrix matrix = AffineToMatrix(scene->nodeLocalToWorld[index]);
+    Model model = sceneModel->model;
+    float maxScale = 0.0f;
+    if (testMeshes)
+    {
+        maxScale = GetSceneMatrixMaxScale(matrix);
     }
-    if (drawBoundingBoxes)
+    for (int i = 0; i < model.meshCount; i++)
     {
-        for (int i = 0; i < scene->nodesCount; i++)
+        if (testMeshes)
         {
-            SceneNode *node = &scene->nodes[i];
-            if (node->generation < 0)
+            // the bounding sphere decides most meshes, only those it leaves open get the box test
+            int sphereResult = CheckSceneSphereFrustum(sceneModel->meshBoundingSpheres[i], frustumPlanes, matrix, maxScale);
+            if (sphereResult == SCENE_CULL_OUTSIDE)
             {
+                stats->culledMeshCount++;
+                stats->sphereCulledMeshCount++;
                 continue;
             }
-
-            SceneModel *sceneModel = &scene->models[node->model.id];
-            if (sceneModel->generation != node->model.generation)
+            if (sphereResult == SCENE_CULL_INSIDE)
             {
-                continue;
+                stats->sphereAcceptedMeshCount++;
+            }
+            else
+            {
+                stats->boxTestedMeshCount++;
+                if (!CheckCollisionBoxFrustum(sceneModel->meshBounds[i], frustumPlanes, matrix))
+                {
+                    stats->culledMeshCount++;
+                    continue;
+                }
+            }
+        }
+
+        Color color = model.materials[model.meshMaterial[i]].maps[MATERIAL_MAP_DIFFUSE].color;
+
+        Color colorTint = WHITE;
+        model.materials[model.meshMaterial[i]].maps[MATERIAL_MAP_DIFFUSE].color = colorTint;
+        DrawMesh(model.meshes[i], model.materials[model.meshMaterial[i]], matrix);
+        model.materials[model.meshMaterial[i]].maps[MATERIAL_MAP_DIFFUSE].color = color;
+
+        stats->meshDrawCount++;
+        stats->trianglesDrawCount += model.meshes[i].vertexCount / 3;
+    }
+}
+
+// leaves below intersecting subtrees, and the intersecting nodes themselves, are collected
+// here, so their own bounds can be tested a batch at a time with the CullSceneBoxes kernel
+#define SCENE_DRAW_BATCH_SIZE 256
+
+typedef struct SceneDrawBatch
+{
+    float centers[3][SCENE_DRAW_BATCH_SIZE];
+    float extents[3][SCENE_DRAW_BATCH_SIZE];
+    unsigned int nodeIndices[SCENE_DRAW_BATCH_SIZE];
+    unsigned int visibleIndices[SCENE_DRAW_BATCH_SIZE];
+    unsigned char insideFlags[SCENE_DRAW_BATCH_SIZE];
+    unsigned long count;
+} SceneDrawBatch;
+
+// culls the batched nodes by their bounds and draws the meshes of the others, with the mesh
+// tests unless the bounds are entirely inside. Leaves count as subtrees in the stats
+static void DrawSceneBatch(Scene *scene, SceneDrawBatch *batch, Vector4 *frustumPlanes, SceneDrawStats *stats)
+{
+    SceneBoxArrays boxes = {
+        batch->centers[0], batch->centers[1], batch->centers[2],
+        batch->extents[0], batch->extents[1], batch->extents[2]};
+    unsigned long visibleCount = ClassifySceneBoxes(boxes, batch->count, frustumPlanes, batch->visibleIndices, batch->insideFlags);
+    unsigned long next = 0;
+    for (unsigned long i = 0; i < batch->count; i++)
+    {
+        unsigned int index = batch->nodeIndices[i];
+        int isLeaf = scene->nodes[index].firstChild == SCENE_NODE_INDEX_NONE;
+        if (next < visibleCount && batch->visibleIndices[next] == i)
+        {
+            int isInside = batch->insideFlags[next];
+            if (isInside && isLeaf)
+            {
+                stats->acceptedSubtreeCount++;
+            }
+            DrawSceneNodeMeshes(scene, index, frustumPlanes, !isInside, stats);
+            next++;
+        }
+        else
+        {
+            stats->culledMeshCount += scene->models[scene->nodeModels[index]].model.meshCount;
+            if (isLeaf)
+            {
+                stats->culledSubtreeCount++;
+            }
+            else
+            {
+                stats->culledNodeCount++;
+            }
+        }
+    }
+    batch->count = 0;
+}
+
+static void AddSceneDrawBatchNode(Scene *scene, SceneDrawBatch *batch, unsigned int index, Vector4 *frustumPlanes, SceneDrawStats *stats)
+{
+    BoundingBox box = scene->nodeBounds[index];
+    unsigned long i = batch->count++;
+    batch->centers[0][i] = (box.min.x + box.max.x) * 0.5f;
+    batch->centers[1][i] = (box.min.y + box.max.y) * 0.5f;
+    batch->centers[2][i] = (box.min.z + box.max.z) * 0.5f;
+    batch->extents[0][i] = (box.max.x - box.min.x) * 0.5f;
+    batch->extents[1][i] = (box.max.y - box.min.y) * 0.5f;
+    batch->extents[2][i] = (box.max.z - box.min.z) * 0.5f;
+    batch->nodeIndices[i] = index;
+    if (batch->count == SCENE_DRAW_BATCH_SIZE)
+    {
+        DrawSceneBatch(scene, batch, frustumPlanes, stats);
+    }
+}
+
+SceneDrawStats DrawScene(SceneId sceneId, SceneDrawConfig config)
+{
+    SceneDrawStats stats = {0};
+    if (!IsSceneValid(sceneId))
+    {
+        return stats;
+    }
+
+    Matrix transform = config.transform;
+    unsigned long layerMask = config.layerMask;
+    int sortMode = config.sortMode;
+    char drawBoundingBoxes = config.drawBoundingBoxes;
+
+    Vector4 frustumPlanes[6];
+    GetSceneFrustumPlanes(GetSceneViewProjection(config), frustumPlanes);
+
+    if (config.drawCameraFrustum)
+    {
+        DrawPlaneEq(frustumPlanes[0], GREEN);
+        DrawPlaneEq(frustumPlanes[1], GREEN);
+        DrawPlaneEq(frustumPlanes[2], GREEN);
+        DrawPlaneEq(frustumPlanes[3], GREEN);
+        DrawPlaneEq(frustumPlanes[4], GREEN);
+        DrawPlaneEq(frustumPlanes[5], GREEN);
+    }
+
+
+    UpdateSceneTransforms(sceneId);
+
+    Scene *scene = &scenes[sceneId.id];
+    SceneDrawBatch batch;
+    batch.count = 0;
+    for (unsigned long i = 0; i < scene->rootNodesCount; i++)
+    {
+        // depth first along the tree links; everything below insideRoot is drawn without tests
+        unsigned int root = scene->rootNodes[i];
+        unsigned int insideRoot = SCENE_NODE_INDEX_NONE;
+        unsigned int index = root;
+        while (1)
+        {
+            int isVisible = 0;
+            if (scene->nodeSubtreeMeshCounts[index] > 0)
+            {
+                isVisible = 1;
+                if (insideRoot != SCENE_NODE_INDEX_NONE)
+                {
+                    DrawSceneNodeMeshes(scene, index, frustumPlanes, 0, &stats);
+                }
+                else if (scene->nodes[index].firstChild == SCENE_NODE_INDEX_NONE)
+                {
+                    // a leaf's subtree bounds are its own bounds, so the batch decides it alone
+                    AddSceneDrawBatchNode(scene, &batch, index, frustumPlanes, &stats);
+                }
+                else
+                {
+                    int result = CheckSceneBoundsFrustum(scene->nodeSubtreeBounds[index], frustumPlanes);
+                    if (result == SCENE_CULL_OUTSIDE)
+                    {
+                        stats.culledMeshCount += scene->nodeSubtreeMeshCounts[index];
+                        stats.culledSubtreeCount++;
+                        isVisible = 0;
+                    }
+                    else if (result == SCENE_CULL_INSIDE)
+                    {
+                        stats.acceptedSubtreeCount++;
+                        insideRoot = index;
+                        DrawSceneNodeMeshes(scene, index, frustumPlanes, 0, &stats);
+                    }
+                    else if (scene->nodeModels[index] >= 0)
+                    {
+                        AddSceneDrawBatchNode(scene, &batch, index, frustumPlanes, &stats);
+                    }
+                }
+            }
+
+            if (isVisible && scene->nodes[index].firstChild != SCENE_NODE_INDEX_NONE)
+            {
+                index = scene->nodes[index].firstChild;
+                continue;
+            }
+            while (index != root && scene->nodes[index].nextSibling == SCENE_NODE_INDEX_NONE)
+            {
+                if (index == insideRoot)
+                {
+                    insideRoot = SCENE_NODE_INDEX_NONE;
+                }
+                index = scene->nodeParents[index];
+            }
+            if (index == root)
+            {
+                break;
+            }
+            if (index == insideRoot)
+            {
+                insideRoot = SCENE_NODE_INDEX_NONE;
+            }
+            index = scene->nodes[index].nextSibling;
+        }
+    }
+    if (batch.count > 0)
+    {
+        DrawSceneBatch(scene, &batch, frustumPlanes, &stats);
+    }
+    if (drawBoundingBoxes)
+    {
+        for (int i = 0; i < scene->nodesCount; i++)
+        {
+            if (scene->nodeModels[i] < 0)
+            {
+                continue;
             }
 
-            Matrix matrix = GetSceneNodeLocalTransform((SceneNodeId){sceneId, i, node->generation});
+            SceneModel *sceneModel = &scene->models[scene->nodeModels[i]];
+            Matrix matrix = AffineToMatrix(scene->nodeLocalToWorld[i]);
             Model model = sceneModel->model;
             rlPushMatrix();
             rlMultMatrixf(MatrixToFloat(matrix));
@@ -414,7 +1303,7 @@ SceneModelId AddModelToScene(SceneId sceneId, Model model, const char *name, int
     }
 
     Scene *scene = &scenes[sceneId.id];
-    SceneModel *sceneModel = ListAlloc((void **)&scene->models, &scene->modelsCount, &scene->modelsCapacity, sizeof(SceneModel));
+    SceneModel *sceneModel = ListAlloc(scene, (void **)&scene->models, &scene->modelsCount, &scene->modelsCapacity, sizeof(SceneModel));
     int index = scene->modelsCount - 1;
     *sceneModel = (SceneModel){
         .generation = sceneModel->generation + 1,
@@ -422,12 +1311,15 @@ SceneModelId AddModelToScene(SceneId sceneId, Model model, const char *name, int
         .name = name,
         .isManaged = manageModel};
     
-    sceneModel->meshBounds = MemAlloc(sizeof(BoundingBox) * model.meshCount);
-    sceneModel->meshBoundingSpheres = MemAlloc(sizeof(Vector4) * model.meshCount);
+    sceneModel->meshBounds = AllocateSceneMemory(scene, sizeof(BoundingBox) * model.meshCount);
+    sceneModel->meshBoundingSpheres = AllocateSceneMemory(scene, sizeof(Vector4) * model.meshCount);
+    sceneModel->bounds = SCENE_EMPTY_BOUNDS;
     for (int i = 0; i < model.meshCount; i++)
     {
         BoundingBox box = GetMeshBoundingBox(model.meshes[i]);
         sceneModel->meshBounds[i] = box;
+        sceneModel->bounds.min = Vector3Min(sceneModel->bounds.min, box.min);
+        sceneModel->bounds.max = Vector3Max(sceneModel->bounds.max, box.max);
         Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
         float radius = Vector3Distance(center, box.max);
         sceneModel->meshBoundingSpheres[i] = (Vector4){center.x, center.y, center.z, radius};
@@ -446,6 +1338,21 @@ static Scene *GetScene(SceneId sceneId)
     return &scenes[sceneId.id];
 }
 
+void SetSceneFlags(SceneId sceneId, unsigned int flags)
+{
+    Scene *scene = GetScene(sceneId);
+    if (scene)
+    {
+        scene->flags = flags;
+    }
+}
+
+unsigned int GetSceneFlags(SceneId sceneId)
+{
+    Scene *scene = GetScene(sceneId);
+    return scene ? scene->flags : 0;
+}
+
 void AddGLTFScene(SceneId sceneId, const char *filename, Matrix transform)
 {
     if (!IsSceneValid(sceneId))
@@ -454,304 +1361,3649 @@ void AddGLTFScene(SceneId sceneId, const char *filename, Matrix transform)
     }
 }
 
-SceneNodeId AcquireSceneNode(SceneId sceneId)
+static void ResizeSceneNodeArrays(Scene *scene, unsigned long capacity)
 {
-    Scene *scene = GetScene(sceneId);
-    if (!scene)
+    scene->nodes = ResizeSceneArray(scene, scene->nodes, scene->nodesCapacity * sizeof(SceneNode), capacity * sizeof(SceneNode));
+    scene->nodeIds = ResizeSceneArray(scene, scene->nodeIds, scene->nodesCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+    scene->nodePositions = ResizeSceneArray(scene, scene->nodePositions, scene->nodesCapacity * sizeof(Vector3), capacity * sizeof(Vector3));
+    scene->nodeRotations = ResizeSceneArray(scene, scene->nodeRotations, scene->nodesCapacity * sizeof(Vector3), capacity * sizeof(Vector3));
+    scene->nodeRotationsQ = ResizeSceneArray(scene, scene->nodeRotationsQ, scene->nodesCapacity * sizeof(Quaternion), capacity * sizeof(Quaternion));
+    scene->nodeRotationModes = ResizeSceneArray(scene, scene->nodeRotationModes, scene->nodesCapacity * sizeof(unsigned char), capacity * sizeof(unsigned char));
+    scene->nodeTransformKinds = ResizeSceneArray(scene, scene->nodeTransformKinds, scene->nodesCapacity * sizeof(unsigned char), capacity * sizeof(unsigned char));
+    scene->nodeScales = ResizeSceneArray(scene, scene->nodeScales, scene->nodesCapacity * sizeof(Vector3), capacity * sizeof(Vector3));
+    scene->nodeLocalToWorld = ResizeSceneArray(scene, scene->nodeLocalToWorld, scene->nodesCapacity * sizeof(SceneAffineMatrix), capacity * sizeof(SceneAffineMatrix));
+    scene->nodeParents = ResizeSceneArray(scene, scene->nodeParents, scene->nodesCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+    scene->nodeModels = ResizeSceneArray(scene, scene->nodeModels, scene->nodesCapacity * sizeof(int), capacity * sizeof(int));
+    scene->nodeTRSDirty = ResizeSceneArray(scene, scene->nodeTRSDirty, scene->nodesCapacity * sizeof(char), capacity * sizeof(char));
+    scene->nodeStatic = ResizeSceneArray(scene, scene->nodeStatic, scene->nodesCapacity * sizeof(char), capacity * sizeof(char));
+    scene->nodeChanged = ResizeSceneArray(scene, scene->nodeChanged, scene->nodesCapacity * sizeof(char), capacity * sizeof(char));
+    scene->nodeBounds = ResizeSceneArray(scene, scene->nodeBounds, scene->nodesCapacity * sizeof(BoundingBox), capacity * sizeof(BoundingBox));
+    scene->nodeSubtreeBounds = ResizeSceneArray(scene, scene->nodeSubtreeBounds, scene->nodesCapacity * sizeof(BoundingBox), capacity * sizeof(BoundingBox));
+    scene->nodeSubtreeMeshCounts = ResizeSceneArray(scene, scene->nodeSubtreeMeshCounts, scene->nodesCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+    scene->nodeSubtreeBoundsDirty = ResizeSceneArray(scene, scene->nodeSubtreeBoundsDirty, scene->nodesCapacity * sizeof(char), capacity * sizeof(char));
+    scene->nodeBVHLeaves = ResizeSceneArray(scene, scene->nodeBVHLeaves, scene->nodesCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+    scene->nodeBVHDirty = ResizeSceneArray(scene, scene->nodeBVHDirty, scene->nodesCapacity * sizeof(char), capacity * sizeof(char));
+    scene->nodesCapacity = capacity;
+}
+
+static void ResizeSceneNodeIdArrays(Scene *scene, unsigned long capacity)
+{
+    scene->nodeIdIndices = ResizeSceneArray(scene, scene->nodeIdIndices, scene->nodeIdsCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+    scene->nodeIdGenerations = ResizeSceneArray(scene, scene->nodeIdGenerations, scene->nodeIdsCapacity * sizeof(long), capacity * sizeof(long));
+    scene->nodeHandleTags = ResizeSceneArray(scene, scene->nodeHandleTags, scene->nodeIdsCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+    scene->nodeIdsCapacity = capacity;
+}
+
+static unsigned int GetSceneNodeHandleTag(unsigned long sceneIndex, long sceneGeneration, long nodeGeneration)
+{
+    // the node generation is wrapped into 16 bits without ever becoming 0, so a tag is never 0
+    unsigned int generationBits = (unsigned int)((nodeGeneration - 1) % 0xFFFF) + 1;
+    return ((unsigned int)(sceneIndex & 0xFF) << 24) | ((unsigned int)(sceneGeneration & 0xFF) << 16) | generationBits;
+}
+
+// initializes count consecutive node slots starting at index as new root nodes
+static void InitSceneNodes(Scene *scene, unsigned int index, unsigned long count)
+{
+    unsigned long end = index + count;
+    for (unsigned long i = index; i < end; i++)
     {
-        return (SceneNodeId){0};
+        scene->nodes[i] = (SceneNode){
+            .nextSibling = SCENE_NODE_INDEX_NONE,
+            .prevSibling = SCENE_NODE_INDEX_NONE,
+            .firstChild = SCENE_NODE_INDEX_NONE,
+            .nameId = 0,
+            .firstComponent = SCENE_NODE_INDEX_NONE,
+            .userIdentifier = 0};
+        scene->nodePositions[i] = (Vector3){0, 0, 0};
+        scene->nodeRotations[i] = (Vector3){0, 0, 0};
+        scene->nodeRotationsQ[i] = QuaternionIdentity();
+        scene->nodeScales[i] = (Vector3){1, 1, 1};
+        scene->nodeLocalToWorld[i] = SCENE_AFFINE_IDENTITY;
+        scene->nodeParents[i] = SCENE_NODE_INDEX_NONE;
+        scene->nodeModels[i] = -1;
+        scene->nodeRotationModes[i] = SCENE_ROTATION_EULER;
+        scene->nodeTransformKinds[i] = SCENE_TRANSFORM_TRANSLATION;
+        scene->nodeTRSDirty[i] = 1;
+        scene->nodeStatic[i] = 0;
+        scene->nodeChanged[i] = 0;
+        scene->nodeBounds[i] = SCENE_EMPTY_BOUNDS;
+        scene->nodeSubtreeBounds[i] = SCENE_EMPTY_BOUNDS;
+        scene->nodeSubtreeMeshCounts[i] = 0;
+        scene->nodeSubtreeBoundsDirty[i] = 0;
+        scene->nodeBVHLeaves[i] = SCENE_NODE_INDEX_NONE;
+        scene->nodeBVHDirty[i] = 0;
     }
+}
 
-    SceneNode *node = GetSceneNode(scene->firstFree, 0);
-    int index;
-    if (!node)
+// binds the node slot to a released or a new id; the id arrays must have room for a new id
+static SceneNodeId AssignSceneNodeId(Scene *scene, SceneId sceneId, unsigned int index)
+{
+    // released ids keep their negated generation
+    unsigned int id;
+    long generation;
+    if (scene->firstFreeId != SCENE_NODE_INDEX_NONE)
     {
-        node = ListAlloc((void **)&scene->nodes, &scene->nodesCount, &scene->nodesCapacity, sizeof(SceneNode));
-        index = scene->nodesCount - 1;
+        id = scene->firstFreeId;
+        generation = -scene->nodeIdGenerations[id] + 1;
+        scene->firstFreeId = scene->nodeIdIndices[id];
     }
     else
     {
-        index = scene->firstFree.id;
-        scene->firstFree = node->nextSiblingId;
+        id = scene->nodeIdsCount++;
+        generation = 1;
     }
 
-    *node = (SceneNode){
-        .generation = node->generation + 1,
-        .position = (Vector3){0, 0, 0},
-        .rotation = (Vector3){0, 0, 0},
-        .scale = (Vector3){1, 1, 1},
-        .name = 0,
-        .modTRSMarker = 0,
-        .modTRSGeneration = 1,
-        .localToWorld = MatrixIdentity(),
-        .worldToLocal = MatrixIdentity(),
-        .userIdentifier = 0,
-        .parent = (SceneNodeId){0},
-        .model = (SceneModelId){0}};
-
-    return (SceneNodeId){sceneId, index, node->generation};
+    scene->nodeIdIndices[id] = index;
+    scene->nodeIdGenerations[id] = generation;
+    scene->nodeHandleTags[id] = GetSceneNodeHandleTag(sceneId.id, sceneId.generation, generation);
+    scene->nodeIds[index] = id;
+    return (SceneNodeId){sceneId, id, generation};
 }
 
-static unsigned long GetSceneNodeGenerationSum(SceneNode *node)
-{
-    unsigned long generationSum = node->modTRSGeneration;
-    SceneNode *parentNode = GetSceneNode(node->parent, 0);
-    while (parentNode)
-    {
-        // TraceLog(LOG_INFO, "parentNode: %p", parentNode);
-        generationSum += parentNode->modTRSGeneration;
-        parentNode = GetSceneNode(parentNode->parent, 0);
-    }
+// # Node names
+// Names are interned per scene: every distinct string is stored once and referred to by a
+// 32-bit name id, so naming the nodes of imported rigs doesn't allocate per node. Named nodes
+// are found through a hash index keyed by the parent id and the name id.
 
-    return generationSum;
-}
+#define SCENE_NAME_BLOCK_SIZE 4096
+// parent key of the name index entries that list a node scene wide
+#define SCENE_NAME_ANY_PARENT 0xFFFFFFFEu
+// chains of the nodes sharing a name index entry
+#define SCENE_NAME_CHAIN_SCENE 0
+#define SCENE_NAME_CHAIN_PARENT 1
 
-// returns the node if it is dirty, otherwise 0; saves pointer resolving for callee
-static SceneNode *IsSceneNodeTRSDirty(SceneNodeId sceneNodeId)
+static unsigned int HashSceneName(const char *name, unsigned long length)
 {
-    Scene *scene;
-    SceneNode *node = GetSceneNode(sceneNodeId, &scene);
-    if (!node)
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+    for (unsigned long i = 0; i < length; i++)
     {
-        return 0;
+        hash = (hash ^ (unsigned char)name[i]) * 16777619u;
     }
-
-    unsigned long generationSum = GetSceneNodeGenerationSum(node);
-    return node->modTRSMarker != generationSum ? node : 0;
+    return hash;
 }
 
-static SceneNode *GetSceneNode(SceneNodeId sceneNodeId, Scene **sceneOut)
+// returns the slot of the name in namesTable or the empty slot where it belongs
+static unsigned int FindSceneNameSlot(Scene *scene, const char *name, unsigned long length, unsigned int hash)
 {
-    Scene *scene = GetScene(sceneNodeId.sceneId);
-    if (!scene)
+    unsigned int mask = scene->namesTableCapacity - 1;
+    for (unsigned int slot = hash & mask;; slot = (slot + 1) & mask)
     {
-        return 0;
+        unsigned int nameId = scene->namesTable[slot];
+        if (nameId == 0 || (scene->nameHashes[nameId] == hash &&
+            strncmp(scene->names[nameId], name, length) == 0 && scene->names[nameId][length] == '\0'))
+        {
+            return slot;
+        }
     }
+}
 
-    if (sceneNodeId.id >= scene->nodesCount || scene->nodes[sceneNodeId.id].generation != sceneNodeId.generation)
+// returns the name id of the string or 0 if it was never interned
+static unsigned int LookupSceneName(Scene *scene, const char *name, unsigned long length)
+{
+    if (scene->namesTableCapacity == 0)
     {
         return 0;
     }
 
-    if (sceneOut)
-        *sceneOut = scene;
-
-    return &scene->nodes[sceneNodeId.id];
+    return scene->namesTable[FindSceneNameSlot(scene, name, length, HashSceneName(name, length))];
 }
 
-int IsSceneNodeValid(SceneNodeId sceneNodeId)
+static const char *StoreSceneName(Scene *scene, const char *name, unsigned long length)
 {
-    Scene *scene;
-    return GetSceneNode(sceneNodeId, &scene) != 0;
+    unsigned long size = length + 1;
+    if (!scene->nameBlock || scene->nameBlockUsed + size > scene->nameBlockSize)
+    {
+        unsigned long blockSize = sizeof(char *) + size;
+        if (blockSize < SCENE_NAME_BLOCK_SIZE)
+        {
+            blockSize = SCENE_NAME_BLOCK_SIZE;
+        }
+        char *block = AllocateSceneMemory(scene, blockSize);
+        memcpy(block, &scene->nameBlock, sizeof(char *));
+        scene->nameBlock = block;
+        scene->nameBlockUsed = sizeof(char *);
+        scene->nameBlockSize = blockSize;
+    }
+
+    char *stored = scene->nameBlock + scene->nameBlockUsed;
+    memcpy(stored, name, length);
+    stored[length] = '\0';
+    scene->nameBlockUsed += size;
+    return stored;
 }
 
-void SetSceneNodeParent(SceneNodeId sceneNodeId, SceneNodeId parentSceneNodeId)
+// returns the name id of the string, interning it first if needed
+static unsigned int InternSceneName(Scene *scene, const char *name, unsigned long length)
 {
-    if (parentSceneNodeId.sceneId.id != sceneNodeId.sceneId.id)
+    if (scene->namesCount + 1 > scene->namesCapacity)
     {
-        TraceLog(LOG_WARNING, "SetSceneNodeParent: scene node and parent must be in the same scene");
-        return;
+        unsigned int capacity = scene->namesCapacity == 0 ? 64 : scene->namesCapacity * 2;
+        scene->names = ResizeSceneArray(scene, scene->names, scene->namesCapacity * sizeof(const char *), capacity * sizeof(const char *));
+        scene->nameHashes = ResizeSceneArray(scene, scene->nameHashes, scene->namesCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+        scene->namesCapacity = capacity;
+        if (scene->namesCount == 0)
+        {
+            // name id 0 is reserved for unnamed nodes
+            scene->names[0] = 0;
+            scene->nameHashes[0] = 0;
+            scene->namesCount = 1;
+        }
     }
 
-    Scene *scene;
-    SceneNode *node = GetSceneNode(sceneNodeId, &scene);
-    if (!node)
+    // the table is kept at most half full
+    if (scene->namesCount * 2 >= scene->namesTableCapacity)
     {
-        return;
+        ReleaseSceneMemory(scene, scene->namesTable);
+        scene->namesTableCapacity = scene->namesTableCapacity == 0 ? 128 : scene->namesTableCapacity * 2;
+        scene->namesTable = AllocateSceneMemory(scene, scene->namesTableCapacity * sizeof(unsigned int));
+        memset(scene->namesTable, 0, scene->namesTableCapacity * sizeof(unsigned int));
+        unsigned int mask = scene->namesTableCapacity - 1;
+        for (unsigned int nameId = 1; nameId < scene->namesCount; nameId++)
+        {
+            unsigned int slot = scene->nameHashes[nameId] & mask;
+            while (scene->namesTable[slot] != 0)
+            {
+                slot = (slot + 1) & mask;
+            }
+            scene->namesTable[slot] = nameId;
+        }
     }
 
-    SceneNode *parentNode = GetSceneNode(parentSceneNodeId, 0);
-    if (!parentNode)
+    unsigned int hash = HashSceneName(name, length);
+    unsigned int slot = FindSceneNameSlot(scene, name, length, hash);
+    if (scene->namesTable[slot] != 0)
     {
-        return;
+        return scene->namesTable[slot];
     }
 
-    node->parent = parentSceneNodeId;
-    node->nextSiblingId = parentNode->firstChildId;
-    parentNode->firstChildId = sceneNodeId;
-    node->modTRSGeneration = 0;
+    unsigned int nameId = scene->namesCount++;
+    scene->names[nameId] = StoreSceneName(scene, name, length);
+    scene->nameHashes[nameId] = hash;
+    scene->namesTable[slot] = nameId;
+    return nameId;
 }
 
-// releases a scene node (destroy) and all its children
-void ReleaseSceneNode(SceneNodeId sceneNodeId)
+static unsigned int HashSceneNameIndexKey(unsigned int parentKey, unsigned int nameId)
 {
-    Scene *scene;
-    SceneNode *node = GetSceneNode(sceneNodeId, &scene);
-    if (!node)
-    {
-        return;
-    }
+    unsigned int hash = (parentKey * 0x9E3779B1u) ^ (nameId * 0x85EBCA77u);
+    return hash ^ (hash >> 15);
+}
 
-    SceneNode *parentNode = GetSceneNode(node->parent, 0);
-    if (parentNode)
+// returns the slot of the key in the name index or the empty slot where it belongs
+static unsigned int FindSceneNameIndexSlot(Scene *scene, unsigned int parentKey, unsigned int nameId)
+{
+    unsigned int mask = (unsigned int)scene->nameIndexCapacity - 1;
+    for (unsigned int slot = HashSceneNameIndexKey(parentKey, nameId) & mask;; slot = (slot + 1) & mask)
     {
-        // remove from parent child list
-        SceneNodeId siblingId = parentNode->firstChildId;
-        if (siblingId.id == sceneNodeId.id)
+        SceneNameIndexEntry *entry = &scene->nameIndex[slot];
+        if (entry->nodeId == SCENE_NODE_INDEX_NONE || (entry->parentKey == parentKey && entry->nameId == nameId))
         {
-            parentNode->firstChildId = node->nextSiblingId;
+            return slot;
         }
-        else
+    }
+}
+
+// returns the id of a node with the name under the parent key or SCENE_NODE_INDEX_NONE;
+// the one listed first is returned if several match
+static unsigned int FindSceneNameIndexEntry(Scene *scene, unsigned int parentKey, unsigned int nameId)
+{
+    if (scene->nameIndexCapacity == 0)
+    {
+        return SCENE_NODE_INDEX_NONE;
+    }
+
+    return scene->nameIndex[FindSceneNameIndexSlot(scene, parentKey, nameId)].nodeId;
+}
+
+static void AddSceneNameIndexEntry(Scene *scene, unsigned int parentKey, unsigned int nameId, unsigned int nodeId, int chain)
+{
+    // the table is kept at most half full
+    if ((scene->nameIndexCount + 1) * 2 > scene->nameIndexCapacity)
+    {
+        SceneNameIndexEntry *entries = scene->nameIndex;
+        unsigned long capacity = scene->nameIndexCapacity;
+        scene->nameIndexCapacity = capacity == 0 ? 128 : capacity * 2;
+        scene->nameIndex = AllocateSceneMemory(scene, scene->nameIndexCapacity * sizeof(SceneNameIndexEntry));
+        // all bits set marks every entry as empty
+        memset(scene->nameIndex, 0xFF, scene->nameIndexCapacity * sizeof(SceneNameIndexEntry));
+        for (unsigned long i = 0; i < capacity; i++)
         {
-            SceneNode *sibling = GetSceneNode(siblingId, 0);
-            while (sibling && sibling->nextSiblingId.id != sceneNodeId.id)
+            if (entries[i].nodeId != SCENE_NODE_INDEX_NONE)
             {
-                siblingId = sibling->nextSiblingId;
-                sibling = GetSceneNode(siblingId, 0);
+                scene->nameIndex[FindSceneNameIndexSlot(scene, entries[i].parentKey, entries[i].nameId)] = entries[i];
             }
-            sibling->nextSiblingId = node->nextSiblingId;
         }
+        ReleaseSceneMemory(scene, entries);
     }
 
-    node->generation++;
-    if (node->name)
+    SceneNode *node = &scene->nodes[scene->nodeIdIndices[nodeId]];
+    SceneNameIndexEntry *entry = &scene->nameIndex[FindSceneNameIndexSlot(scene, parentKey, nameId)];
+    node->prevNamed[chain] = SCENE_NODE_INDEX_NONE;
+    if (entry->nodeId != SCENE_NODE_INDEX_NONE)
     {
-        MemFree(node->name);
-        node->name = 0;
+        // the node goes to the front of the chain of the key
+        node->nextNamed[chain] = entry->nodeId;
+        scene->nodes[scene->nodeIdIndices[entry->nodeId]].prevNamed[chain] = nodeId;
     }
-
-    // release children
-    SceneNodeId childId = node->firstChildId;
-    SceneNode* child = GetSceneNode(childId, 0);
-    while (child)
+    else
     {
-        SceneNodeId nextChildId = child->nextSiblingId;
-        ReleaseSceneNode(childId);
-        child = GetSceneNode(nextChildId, 0);
-        childId = nextChildId;
+        node->nextNamed[chain] = SCENE_NODE_INDEX_NONE;
+        entry->parentKey = parentKey;
+        entry->nameId = nameId;
+        scene->nameIndexCount++;
     }
-
-    // add to free list
-    node->parent = (SceneNodeId){0};
-    node->nextSiblingId = scene->firstFree;
-    scene->firstFree = sceneNodeId;
+    entry->nodeId = nodeId;
 }
 
-void SetSceneNodePosition(SceneNodeId sceneNodeId, float x, float y, float z)
+static void RemoveSceneNameIndexEntry(Scene *scene, unsigned int parentKey, unsigned int nameId, unsigned int nodeId, int chain)
 {
-    SceneNode *node = GetSceneNode(sceneNodeId, 0);
-    if (!node)
+    SceneNode *node = &scene->nodes[scene->nodeIdIndices[nodeId]];
+    unsigned int prev = node->prevNamed[chain];
+    unsigned int next = node->nextNamed[chain];
+    if (next != SCENE_NODE_INDEX_NONE)
+    {
+        scene->nodes[scene->nodeIdIndices[next]].prevNamed[chain] = prev;
+    }
+    if (prev != SCENE_NODE_INDEX_NONE)
     {
+        scene->nodes[scene->nodeIdIndices[prev]].nextNamed[chain] = next;
         return;
     }
 
-    node->position = (Vector3){x, y, z};
-    node->modTRSGeneration += 1;
-}
-
-void SetSceneNodeRotation(SceneNodeId sceneNodeId, float eulerXDeg, float eulerYDeg, float eulerZDeg)
-{
-    SceneNode *node = GetSceneNode(sceneNodeId, 0);
-    if (!node)
+    unsigned int hole = FindSceneNameIndexSlot(scene, parentKey, nameId);
+    if (next != SCENE_NODE_INDEX_NONE)
     {
+        scene->nameIndex[hole].nodeId = next;
         return;
     }
 
-    node->rotation = (Vector3){eulerXDeg, eulerYDeg, eulerZDeg};
-    node->modTRSGeneration += 1;
+    // later entries of the probe sequence are shifted back into the gap, so no tombstones are needed
+    unsigned int mask = (unsigned int)scene->nameIndexCapacity - 1;
+    for (unsigned int slot = (hole + 1) & mask; scene->nameIndex[slot].nodeId != SCENE_NODE_INDEX_NONE; slot = (slot + 1) & mask)
+    {
+        SceneNameIndexEntry *entry = &scene->nameIndex[slot];
+        unsigned int home = HashSceneNameIndexKey(entry->parentKey, entry->nameId) & mask;
+        // the entry may fill the hole if the hole lies between its home slot and its slot
+        if (((slot - home) & mask) >= ((slot - hole) & mask))
+        {
+            scene->nameIndex[hole] = *entry;
+            hole = slot;
+        }
+    }
+    scene->nameIndex[hole].nodeId = SCENE_NODE_INDEX_NONE;
+    scene->nameIndexCount--;
+}
+
+// key of the node's entry under its parent in the name index
+static unsigned int GetSceneNodeNameParentKey(Scene *scene, unsigned int index)
+{
+    unsigned int parentIndex = scene->nodeParents[index];
+    return parentIndex == SCENE_NODE_INDEX_NONE ? SCENE_NODE_INDEX_NONE : scene->nodeIds[parentIndex];
 }
 
-void SetSceneNodeScale(SceneNodeId sceneNodeId, float x, float y, float z)
+static void SetSceneNodeNameId(Scene *scene, unsigned int index, unsigned int nameId)
 {
-    SceneNode *node = GetSceneNode(sceneNodeId, 0);
-    if (!node)
+    SceneNode *node = &scene->nodes[index];
+    unsigned int id = scene->nodeIds[index];
+    if (node->nameId == nameId)
     {
         return;
     }
 
-    node->scale = (Vector3){x, y, z};
-    node->modTRSGeneration += 1;
+    unsigned int parentKey = GetSceneNodeNameParentKey(scene, index);
+    if (node->nameId != 0)
+    {
+        RemoveSceneNameIndexEntry(scene, parentKey, node->nameId, id, SCENE_NAME_CHAIN_PARENT);
+        RemoveSceneNameIndexEntry(scene, SCENE_NAME_ANY_PARENT, node->nameId, id, SCENE_NAME_CHAIN_SCENE);
+    }
+    node->nameId = nameId;
+    if (nameId != 0)
+    {
+        AddSceneNameIndexEntry(scene, parentKey, nameId, id, SCENE_NAME_CHAIN_PARENT);
+        AddSceneNameIndexEntry(scene, SCENE_NAME_ANY_PARENT, nameId, id, SCENE_NAME_CHAIN_SCENE);
+    }
 }
 
-void SetSceneNodePositionV(SceneNodeId sceneNodeId, Vector3 position)
-{
-    SetSceneNodePosition(sceneNodeId, position.x, position.y, position.z);
-}
+// # Node components
+// The components of each definition are kept in a dense pool per scene. Their data is packed
+// by componentDataSize, so all components of a type can be walked linearly, and a removal moves
+// the last component into the gap. The components of a node are chained through their slots.
 
-void SetSceneNodeRotationV(SceneNodeId sceneNodeId, Vector3 rotation)
-{
-    SetSceneNodeRotation(sceneNodeId, rotation.x, rotation.y, rotation.z);
-}
+// the key of a component combines its definition id and slot
+#define SCENE_COMPONENT_KEY(definitionId, slot) (((unsigned int)(definitionId) << 24) | (slot))
+#define SCENE_COMPONENT_MAX_SLOTS 0xFFFFFFu
 
-void SetSceneNodeScaleV(SceneNodeId sceneNodeId, Vector3 scale)
+static SceneNodeId GetSceneNodeIdOfId(Scene *scene, unsigned int id)
 {
-    SetSceneNodeScale(sceneNodeId, scale.x, scale.y, scale.z);
+    SceneId sceneId = {(unsigned long)(scene - scenes), scene->generation};
+    return (SceneNodeId){sceneId, id, scene->nodeIdGenerations[id]};
 }
 
-Vector3 GetSceneNodeLocalPosition(SceneNodeId sceneNodeId)
+// returns the pool of a live component and its packed index, or 0 for stale ids
+static SceneComponentData *GetSceneComponentPool(SceneNodeComponentId componentId, Scene **sceneOut, unsigned int *indexOut)
 {
-    SceneNode *node = GetSceneNode(sceneNodeId, 0);
-    if (!node)
+    Scene *scene = GetScene(componentId.ownerSceneId);
+    if (!scene)
     {
-        return (Vector3){0, 0, 0};
+        return 0;
     }
 
-    return node->position;
-}
-
-Vector3 GetSceneNodeLocalRotation(SceneNodeId sceneNodeId)
-{
-    SceneNode *node = GetSceneNode(sceneNodeId, 0);
-    if (!node)
+    SceneComponentData *pool = &scene->sceneComponentData[componentId.definitionId];
+    unsigned long slot = componentId.componentIndex;
+    if (slot >= pool->slotsCount || pool->slotGenerations[slot] != componentId.generation || !(componentId.generation & 1))
     {
-        return (Vector3){0, 0, 0};
+        return 0;
     }
 
-    return node->rotation;
+    if (sceneOut)
+        *sceneOut = scene;
+    if (indexOut)
+        *indexOut = pool->slotIndices[slot];
+
+    return pool;
 }
 
-Vector3 GetSceneNodeLocalScale(SceneNodeId sceneNodeId)
+// calls onRemove, unlinks the component from its node and fills the gap with the last component
+static void RemoveSceneComponent(Scene *scene, unsigned char definitionId, unsigned int slot)
 {
-    SceneNode *node = GetSceneNode(sceneNodeId, 0);
-    if (!node)
+    SceneComponentData *pool = &scene->sceneComponentData[definitionId];
+    SceneNodeComponentDefinition *definition = &sceneNodeComponentDefinitions[definitionId];
+    unsigned long size = pool->componentDataSize;
+    unsigned int index = pool->slotIndices[slot];
+    unsigned int nodeId = pool->componentNodeIds[index];
+    if (definition->onRemove)
     {
-        return (Vector3){1, 1, 1};
+        definition->onRemove(GetSceneNodeIdOfId(scene, nodeId), pool->componentData + index * size);
     }
 
-    return node->scale;
-}
-
-static SceneNode *UpdateSceneNodeTRS(SceneNodeId sceneNodeId)
-{
-    SceneNode *node = IsSceneNodeTRSDirty(sceneNodeId);
-    if (!node)
+    unsigned int key = SCENE_COMPONENT_KEY(definitionId, slot);
+    unsigned int *link = &scene->nodes[scene->nodeIdIndices[nodeId]].firstComponent;
+    while (*link != key)
     {
-        return GetSceneNode(sceneNodeId, 0);
+        link = &scene->sceneComponentData[*link >> 24].slotNextOfNode[*link & SCENE_COMPONENT_MAX_SLOTS];
     }
+    *link = pool->slotNextOfNode[slot];
 
-    SceneNode *parentNode = GetSceneNode(node->parent, 0);
-    node->localToWorld = MatrixIdentity();
-    node->localToWorld = MatrixMultiply(node->localToWorld, MatrixScale(node->scale.x, node->scale.y, node->scale.z));
-    node->localToWorld = MatrixMultiply(node->localToWorld, MatrixRotateXYZ((Vector3){DEG2RAD * node->rotation.x, DEG2RAD * node->rotation.y, DEG2RAD * node->rotation.z}));
-    node->localToWorld = MatrixMultiply(node->localToWorld, MatrixTranslate(node->position.x, node->position.y, node->position.z));
-    if (parentNode)
+    unsigned long last = pool->count - 1;
+    if (index != last)
     {
-        UpdateSceneNodeTRS(node->parent);
-        node->localToWorld = MatrixMultiply(node->localToWorld, parentNode->localToWorld);
+        memcpy(pool->componentData + index * size, pool->componentData + last * size, size);
+        pool->componentNodeIds[index] = pool->componentNodeIds[last];
+        pool->componentSlots[index] = pool->componentSlots[last];
+        pool->slotIndices[pool->componentSlots[index]] = index;
     }
+    pool->count = last;
 
-    unsigned long generationSum = GetSceneNodeGenerationSum(node);
-    node->modTRSMarker = generationSum;
-
-    return node;
+    // the generation becomes even while the slot is free
+    pool->slotGenerations[slot]++;
+    pool->slotIndices[slot] = pool->firstFreeSlot;
+    pool->firstFreeSlot = slot;
 }
 
-Matrix GetSceneNodeLocalTransform(SceneNodeId sceneNodeId)
+// attaches a component to the node in the slot; the definition must be registered.
+// data may point into the pool itself, e.g. when a component is cloned
+static SceneNodeComponentId AddSceneComponent(Scene *scene, unsigned int index, unsigned char definitionId, const void *data)
 {
-    SceneNode *node = UpdateSceneNodeTRS(sceneNodeId);
-    if (!node)
+    SceneNodeComponentDefinition *definition = &sceneNodeComponentDefinitions[definitionId];
+    SceneComponentData *pool = &scene->sceneComponentData[definitionId];
+    if (pool->slotsCapacity == 0)
     {
-        return MatrixIdentity();
+        pool->componentDataSize = definition->componentDataSize;
+        pool->firstFreeSlot = SCENE_NODE_INDEX_NONE;
     }
+    unsigned long size = pool->componentDataSize;
 
-    return node->localToWorld;
-}
+    unsigned int slot;
+    if (pool->firstFreeSlot != SCENE_NODE_INDEX_NONE)
+    {
+        slot = pool->firstFreeSlot;
+        pool->firstFreeSlot = pool->slotIndices[slot];
+    }
+    else
+    {
+        if (pool->slotsCount >= SCENE_COMPONENT_MAX_SLOTS)
+        {
+            TraceLog(LOG_WARNING, "AddSceneNodeComponent: too many components of definition %d", definitionId);
+            return (SceneNodeComponentId){0};
+        }
+        if (pool->slotsCount >= pool->slotsCapacity)
+        {
+            unsigned long capacity = pool->slotsCapacity == 0 ? 64 : pool->slotsCapacity * 2;
+            pool->slotIndices = ResizeSceneArray(scene, pool->slotIndices, pool->slotsCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+            pool->slotGenerations = ResizeSceneArray(scene, pool->slotGenerations, pool->slotsCapacity * sizeof(unsigned short), capacity * sizeof(unsigned short));
+            pool->slotNextOfNode = ResizeSceneArray(scene, pool->slotNextOfNode, pool->slotsCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+            pool->slotsCapacity = capacity;
+        }
+        slot = pool->slotsCount++;
+        pool->slotGenerations[slot] = 0;
+    }
+    pool->slotGenerations[slot]++;
 
-Vector3 GetSceneNodeWorldPosition(SceneNodeId sceneNodeId)
-{
-    Matrix localToWorld = GetSceneNodeLocalTransform(sceneNodeId);
-    return (Vector3){localToWorld.m12, localToWorld.m13, localToWorld.m14};
-}
+    if (pool->count >= pool->capacity)
+    {
+        const unsigned char *source = data;
+        unsigned long sourceOffset = 0;
+        int isSourceInPool = pool->componentData && source >= pool->componentData && source < pool->componentData + pool->count * size;
+        if (isSourceInPool)
+        {
+            sourceOffset = (unsigned long)(source - pool->componentData);
+        }
+
+        unsigned long capacity = pool->capacity == 0 ? 64 : pool->capacity * 2;
+        pool->componentData = ResizeSceneArray(scene, pool->componentData, pool->capacity * size, capacity * size);
+        pool->componentNodeIds = ResizeSceneArray(scene, pool->componentNodeIds, pool->capacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+        pool->componentSlots = ResizeSceneArray(scene, pool->componentSlots, pool->capacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+        pool->capacity = capacity;
+        if (isSourceInPool)
+        {
+            data = pool->componentData + sourceOffset;
+        }
+    }
+    unsigned int componentIndex = pool->count++;
+    unsigned char *componentData = pool->componentData + componentIndex * size;
+    if (data)
+    {
+        memcpy(componentData, data, size);
+    }
+    else
+    {
+        memset(componentData, 0, size);
+    }
+    pool->componentNodeIds[componentIndex] = scene->nodeIds[index];
+    pool->componentSlots[componentIndex] = slot;
+    pool->slotIndices[slot] = componentIndex;
+
+    SceneNode *node = &scene->nodes[index];
+    pool->slotNextOfNode[slot] = node->firstComponent;
+    node->firstComponent = SCENE_COMPONENT_KEY(definitionId, slot);
+
+    SceneNodeId sceneNodeId = GetSceneNodeIdOfId(scene, scene->nodeIds[index]);
+    if (definition->onAdd)
+    {
+        definition->onAdd(sceneNodeId, componentData);
+    }
+
+    return (SceneNodeComponentId){sceneNodeId.sceneId, slot, pool->slotGenerations[slot], definitionId};
+}
+
+// removes all components of the node
+static void RemoveSceneNodeComponents(Scene *scene, unsigned int index)
+{
+    while (scene->nodes[index].firstComponent != SCENE_NODE_INDEX_NONE)
+    {
+        unsigned int key = scene->nodes[index].firstComponent;
+        RemoveSceneComponent(scene, (unsigned char)(key >> 24), key & SCENE_COMPONENT_MAX_SLOTS);
+    }
+}
+
+// # Node bounds
+// Every node keeps the world bounds of its model, recomputed whenever its localToWorld is, and
+// the bounds of its subtree. Changes mark the node and its ancestors, and UpdateSceneTransforms
+// refits only the marked part of each tree, children before parents, so DrawScene can reject
+// or accept whole subtrees with a single test.
+
+// lists a marked root node, so UpdateSceneBounds finds its tree
+static void AddSceneBoundsDirtyRoot(Scene *scene, unsigned int index)
+{
+    if (scene->boundsDirtyRootsCount >= scene->boundsDirtyRootsCapacity)
+    {
+        unsigned long capacity = scene->boundsDirtyRootsCapacity == 0 ? 64 : scene->boundsDirtyRootsCapacity * 2;
+        scene->boundsDirtyRoots = ResizeSceneArray(scene, scene->boundsDirtyRoots, scene->boundsDirtyRootsCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+        scene->boundsDirtyRootsCapacity = capacity;
+    }
+    scene->boundsDirtyRoots[scene->boundsDirtyRootsCount++] = scene->nodeIds[index];
+}
+
+// marks the subtree bounds of the node and its ancestors for a refit
+static void MarkSceneSubtreeBoundsDirty(Scene *scene, unsigned int index)
+{
+    unsigned int root = SCENE_NODE_INDEX_NONE;
+    for (; index != SCENE_NODE_INDEX_NONE && !scene->nodeSubtreeBoundsDirty[index]; index = scene->nodeParents[index])
+    {
+        scene->nodeSubtreeBoundsDirty[index] = 1;
+        root = index;
+    }
+
+    // if the walk stopped at a marked ancestor, the root is listed already
+    if (index == SCENE_NODE_INDEX_NONE && root != SCENE_NODE_INDEX_NONE)
+    {
+        AddSceneBoundsDirtyRoot(scene, root);
+    }
+}
+
+// plain comparisons instead of fminf/fmaxf, which aren't inlined without -ffast-math
+static BoundingBox UnionSceneBounds(BoundingBox a, BoundingBox b)
+{
+    return (BoundingBox){
+        {a.min.x < b.min.x ? a.min.x : b.min.x, a.min.y < b.min.y ? a.min.y : b.min.y, a.min.z < b.min.z ? a.min.z : b.min.z},
+        {a.max.x > b.max.x ? a.max.x : b.max.x, a.max.y > b.max.y ? a.max.y : b.max.y, a.max.z > b.max.z ? a.max.z : b.max.z}};
+}
+
+// world bounds of the box transformed by the matrix
+static BoundingBox TransformSceneBounds(BoundingBox box, SceneAffineMatrix m)
+{
+    if (box.min.x > box.max.x)
+    {
+        return box;
+    }
+
+    Vector3 c = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+    Vector3 e = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+    Vector3 center = {
+        m.m0 * c.x + m.m4 * c.y + m.m8 * c.z + m.m12,
+        m.m1 * c.x + m.m5 * c.y + m.m9 * c.z + m.m13,
+        m.m2 * c.x + m.m6 * c.y + m.m10 * c.z + m.m14};
+    Vector3 extent = {
+        fabsf(m.m0) * e.x + fabsf(m.m4) * e.y + fabsf(m.m8) * e.z,
+        fabsf(m.m1) * e.x + fabsf(m.m5) * e.y + fabsf(m.m9) * e.z,
+        fabsf(m.m2) * e.x + fabsf(m.m6) * e.y + fabsf(m.m10) * e.z};
+    return (BoundingBox){Vector3Subtract(center, extent), Vector3Add(center, extent)};
+}
+
+// world bounds of the node's model. Translation and y rotation nodes keep their kind in world
+// space as long as their ancestors don't rotate or scale them, which the matrix tells: then the
+// box is only offset, or its y extent is kept and the y row left out
+static BoundingBox TransformSceneNodeBounds(Scene *scene, unsigned int index)
+{
+    BoundingBox box = scene->models[scene->nodeModels[index]].bounds;
+    SceneAffineMatrix m = scene->nodeLocalToWorld[index];
+    unsigned char kind = scene->nodeTransformKinds[index];
+    if (kind == SCENE_TRANSFORM_GENERAL || box.min.x > box.max.x || m.m1 != 0.0f || m.m4 != 0.0f || m.m6 != 0.0f || m.m9 != 0.0f)
+    {
+        return TransformSceneBounds(box, m);
+    }
+
+    if (kind == SCENE_TRANSFORM_TRANSLATION && m.m0 == 1.0f && m.m5 == 1.0f && m.m10 == 1.0f && m.m2 == 0.0f && m.m8 == 0.0f)
+    {
+        Vector3 offset = {m.m12, m.m13, m.m14};
+        return (BoundingBox){Vector3Add(box.min, offset), Vector3Add(box.max, offset)};
+    }
+
+    Vector3 c = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+    Vector3 e = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+    Vector3 center = {m.m0 * c.x + m.m8 * c.z + m.m12, m.m5 * c.y + m.m13, m.m2 * c.x + m.m10 * c.z + m.m14};
+    Vector3 extent = {fabsf(m.m0) * e.x + fabsf(m.m8) * e.z, fabsf(m.m5) * e.y, fabsf(m.m2) * e.x + fabsf(m.m10) * e.z};
+    return (BoundingBox){Vector3Subtract(center, extent), Vector3Add(center, extent)};
+}
+
+// recomputes the node's own bounds from its localToWorld and marks the subtree bounds up to the root
+static void UpdateSceneNodeBounds(Scene *scene, unsigned int index)
+{
+    scene->nodeBounds[index] = scene->nodeModels[index] >= 0 ? TransformSceneNodeBounds(scene, index) : SCENE_EMPTY_BOUNDS;
+    MarkSceneSubtreeBoundsDirty(scene, index);
+}
+
+// # Spatial index
+// For the queries, nodes with models are also kept in AABB trees over their world bounds, which
+// follow the space rather than the node hierarchy. The trees are only brought up to date when a
+// query runs; until then, transform updates just list the nodes that moved. Static subtrees
+// change rarely: they are built into staticBVH top-down with the surface area heuristic whenever
+// the set of static nodes changes. All other nodes live in dynamicBVH, where a new leaf goes
+// next to the node it adds the least area to, and a moved leaf only marks its ancestors. Marked
+// nodes are refit children before parents and rotated where swapping a child with a grandchild
+// shrinks the tree. Rotations only repair the tree locally, so once nodes have moved far enough
+// to double its cost, dynamicBVH is rebuilt with the heuristic as well. When many leaves have
+// moved, the whole tree is refit without rotations and new leaves wait for a rebuild instead.
+
+#define SCENE_BVH_BIN_COUNT 16
+// below this depth the static build splits in the middle, which bounds the depth of the tree
+#define SCENE_BVH_MAX_SAH_DEPTH 48
+#define SCENE_BVH_REBUILD_FACTOR 2.0f
+
+// proportional to the surface area of the box
+static float GetSceneBoundsArea(BoundingBox box)
+{
+    Vector3 size = Vector3Subtract(box.max, box.min);
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+// sets the box of an inner node, keeping track of the area of the tree
+static void SetSceneBVHNodeBounds(SceneBVH *bvh, unsigned int index, BoundingBox bounds)
+{
+    bvh->innerArea += GetSceneBoundsArea(bounds) - GetSceneBoundsArea(bvh->nodes[index].bounds);
+    bvh->nodes[index].bounds = bounds;
+}
+
+static float GetSceneBVHCost(SceneBVH *bvh)
+{
+    float rootArea = GetSceneBoundsArea(bvh->nodes[bvh->root].bounds);
+    return rootArea > 0.0f ? (float)(bvh->innerArea / rootArea) : 0.0f;
+}
+
+static unsigned int AllocateSceneBVHNode(Scene *scene, SceneBVH *bvh)
+{
+    unsigned int index = bvh->firstFree;
+    if (index != SCENE_NODE_INDEX_NONE)
+    {
+        bvh->firstFree = bvh->nodes[index].child1;
+    }
+    else
+    {
+        if (bvh->count >= bvh->capacity)
+        {
+            unsigned long capacity = bvh->capacity == 0 ? 64 : bvh->capacity * 2;
+            bvh->nodes = ResizeSceneArray(scene, bvh->nodes, bvh->capacity * sizeof(SceneBVHNode), capacity * sizeof(SceneBVHNode));
+            bvh->capacity = capacity;
+        }
+        index = (unsigned int)bvh->count++;
+    }
+
+    bvh->nodes[index] = (SceneBVHNode){
+        .parent = SCENE_NODE_INDEX_NONE,
+        .child1 = SCENE_NODE_INDEX_NONE,
+        .child2 = SCENE_NODE_INDEX_NONE,
+        .nodeIndex = SCENE_NODE_INDEX_NONE};
+    return index;
+}
+
+static void FreeSceneBVHNode(SceneBVH *bvh, unsigned int index)
+{
+    bvh->nodes[index].child1 = bvh->firstFree;
+    bvh->firstFree = index;
+}
+
+// marks the inner node and its ancestors for a refit
+static void MarkSceneBVHNodeDirty(SceneBVH *bvh, unsigned int index)
+{
+    if (bvh->isFullRefit)
+    {
+        return;
+    }
+
+    for (; index != SCENE_NODE_INDEX_NONE && !bvh->nodes[index].isDirty; index = bvh->nodes[index].parent)
+    {
+        bvh->nodes[index].isDirty = 1;
+    }
+}
+
+// pairs the leaf with the node where a new parent costs the least area, descending greedily
+static void InsertSceneBVHLeaf(Scene *scene, SceneBVH *bvh, unsigned int leaf)
+{
+    if (bvh->root == SCENE_NODE_INDEX_NONE)
+    {
+        bvh->root = leaf;
+        bvh->isRebuildPending = 1;
+        return;
+    }
+
+    BoundingBox box = bvh->nodes[leaf].bounds;
+    SceneBVHNode *nodes = bvh->nodes;
+    unsigned int index = bvh->root;
+    while (nodes[index].child1 != SCENE_NODE_INDEX_NONE)
+    {
+        // a new parent here costs its area; going further down also grows this node
+        BoundingBox combined = UnionSceneBounds(nodes[index].bounds, box);
+        float combinedArea = GetSceneBoundsArea(combined);
+        float cost = 2.0f * combinedArea;
+        float inheritedCost = 2.0f * (combinedArea - GetSceneBoundsArea(nodes[index].bounds));
+        unsigned int children[2] = {nodes[index].child1, nodes[index].child2};
+        float childCosts[2];
+        for (int i = 0; i < 2; i++)
+        {
+            SceneBVHNode *child = &nodes[children[i]];
+            childCosts[i] = GetSceneBoundsArea(UnionSceneBounds(child->bounds, box)) + inheritedCost;
+            if (child->child1 != SCENE_NODE_INDEX_NONE)
+            {
+                childCosts[i] -= GetSceneBoundsArea(child->bounds);
+            }
+        }
+        if (cost < childCosts[0] && cost < childCosts[1])
+        {
+            break;
+        }
+
+        // the boxes on the way down keep containing the leaf until the next refit
+        SetSceneBVHNodeBounds(bvh, index, combined);
+        index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+    }
+
+    unsigned int sibling = index;
+    unsigned int oldParent = nodes[sibling].parent;
+    unsigned int newParent = AllocateSceneBVHNode(scene, bvh);
+    nodes = bvh->nodes;
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    SetSceneBVHNodeBounds(bvh, newParent, UnionSceneBounds(nodes[sibling].bounds, box));
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+    if (oldParent == SCENE_NODE_INDEX_NONE)
+    {
+        bvh->root = newParent;
+    }
+    else if (nodes[oldParent].child1 == sibling)
+    {
+        nodes[oldParent].child1 = newParent;
+    }
+    else
+    {
+        nodes[oldParent].child2 = newParent;
+    }
+    MarkSceneBVHNodeDirty(bvh, newParent);
+}
+
+// frees the leaf and its parent, whose place is taken by the leaf's sibling
+static void RemoveSceneBVHLeaf(SceneBVH *bvh, unsigned int leaf)
+{
+    SceneBVHNode *nodes = bvh->nodes;
+    unsigned int parent = nodes[leaf].parent;
+    FreeSceneBVHNode(bvh, leaf);
+    if (parent == SCENE_NODE_INDEX_NONE)
+    {
+        bvh->root = SCENE_NODE_INDEX_NONE;
+        return;
+    }
+
+    unsigned int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+    unsigned int grandParent = nodes[parent].parent;
+    nodes[sibling].parent = grandParent;
+    if (grandParent == SCENE_NODE_INDEX_NONE)
+    {
+        bvh->root = sibling;
+    }
+    else
+    {
+        if (nodes[grandParent].child1 == parent)
+        {
+            nodes[grandParent].child1 = sibling;
+        }
+        else
+        {
+            nodes[grandParent].child2 = sibling;
+        }
+        MarkSceneBVHNodeDirty(bvh, grandParent);
+    }
+    bvh->innerArea -= GetSceneBoundsArea(nodes[parent].bounds);
+    FreeSceneBVHNode(bvh, parent);
+}
+
+// swaps a child of the node with a grandchild under its other child, if that shrinks the inner
+// node that changes; everything below the node must be refit already
+static void RotateSceneBVHNode(SceneBVH *bvh, unsigned int index)
+{
+    SceneBVHNode *nodes = bvh->nodes;
+    float bestGain = 0.0f;
+    unsigned int bestChild = SCENE_NODE_INDEX_NONE;
+    unsigned int bestInner = SCENE_NODE_INDEX_NONE;
+    unsigned int bestGrandchild = SCENE_NODE_INDEX_NONE;
+    unsigned int bestKept = SCENE_NODE_INDEX_NONE;
+    for (int side = 0; side < 2; side++)
+    {
+        unsigned int child = side == 0 ? nodes[index].child1 : nodes[index].child2;
+        unsigned int inner = side == 0 ? nodes[index].child2 : nodes[index].child1;
+        if (nodes[inner].child1 == SCENE_NODE_INDEX_NONE)
+        {
+            continue;
+        }
+
+        // the child takes the place of one grandchild, the inner node then holds it and the other
+        float innerArea = GetSceneBoundsArea(nodes[inner].bounds);
+        for (int i = 0; i < 2; i++)
+        {
+            unsigned int grandchild = i == 0 ? nodes[inner].child1 : nodes[inner].child2;
+            unsigned int kept = i == 0 ? nodes[inner].child2 : nodes[inner].child1;
+            float gain = innerArea - GetSceneBoundsArea(UnionSceneBounds(nodes[child].bounds, nodes[kept].bounds));
+            if (gain > bestGain)
+            {
+                bestGain = gain;
+                bestChild = child;
+                bestInner = inner;
+                bestGrandchild = grandchild;
+                bestKept = kept;
+            }
+        }
+    }
+
+    if (bestChild == SCENE_NODE_INDEX_NONE)
+    {
+        return;
+    }
+
+    if (nodes[index].child1 == bestChild)
+    {
+        nodes[index].child1 = bestGrandchild;
+    }
+    else
+    {
+        nodes[index].child2 = bestGrandchild;
+    }
+    nodes[bestGrandchild].parent = index;
+    if (nodes[bestInner].child1 == bestGrandchild)
+    {
+        nodes[bestInner].child1 = bestChild;
+    }
+    else
+    {
+        nodes[bestInner].child2 = bestChild;
+    }
+    nodes[bestChild].parent = bestInner;
+    SetSceneBVHNodeBounds(bvh, bestInner, UnionSceneBounds(nodes[bestChild].bounds, nodes[bestKept].bounds));
+    nodes[bestInner].meshCount = nodes[bestChild].meshCount + nodes[bestKept].meshCount;
+}
+
+// refits the marked nodes in one post-order walk; only inner nodes are ever marked
+static void RefitSceneBVH(SceneBVH *bvh)
+{
+    SceneBVHNode *nodes = bvh->nodes;
+    int isFullRefit = bvh->isFullRefit;
+    if (isFullRefit)
+    {
+        // marks every inner node in one pass over the array; free nodes get marked as well, which
+        // is harmless as they are reset when reused
+        for (unsigned long i = 0; i < bvh->count; i++)
+        {
+            nodes[i].isDirty = nodes[i].child1 != SCENE_NODE_INDEX_NONE;
+        }
+        bvh->isFullRefit = 0;
+    }
+
+    unsigned int index = bvh->root;
+    if (index == SCENE_NODE_INDEX_NONE || !nodes[index].isDirty)
+    {
+        return;
+    }
+
+    while (1)
+    {
+        SceneBVHNode *node = &nodes[index];
+        if (nodes[node->child1].isDirty)
+        {
+            index = node->child1;
+            continue;
+        }
+        if (nodes[node->child2].isDirty)
+        {
+            index = node->child2;
+            continue;
+        }
+
+        if (!isFullRefit)
+        {
+            RotateSceneBVHNode(bvh, index);
+        }
+        SetSceneBVHNodeBounds(bvh, index, UnionSceneBounds(nodes[node->child1].bounds, nodes[node->child2].bounds));
+        node->meshCount = nodes[node->child1].meshCount + nodes[node->child2].meshCount;
+        node->isDirty = 0;
+        if (index == bvh->root)
+        {
+            break;
+        }
+        index = node->parent;
+    }
+}
+
+// brings the node's leaf in dynamicBVH in line with its bounds; nodes without bounds get none
+static void UpdateSceneNodeBVHLeaf(Scene *scene, unsigned int index)
+{
+    SceneBVH *bvh = &scene->dynamicBVH;
+    unsigned int leaf = scene->nodeBVHLeaves[index];
+    BoundingBox bounds = scene->nodeBounds[index];
+    if (bounds.min.x > bounds.max.x)
+    {
+        if (leaf != SCENE_NODE_INDEX_NONE)
+        {
+            RemoveSceneBVHLeaf(bvh, leaf);
+            scene->nodeBVHLeaves[index] = SCENE_NODE_INDEX_NONE;
+        }
+        return;
+    }
+
+    unsigned int meshCount = scene->models[scene->nodeModels[index]].model.meshCount;
+    if (leaf == SCENE_NODE_INDEX_NONE)
+    {
+        leaf = AllocateSceneBVHNode(scene, bvh);
+        bvh->nodes[leaf].bounds = bounds;
+        bvh->nodes[leaf].nodeIndex = index;
+        bvh->nodes[leaf].meshCount = meshCount;
+        scene->nodeBVHLeaves[index] = leaf;
+        // during a full refit, new leaves are left to the rebuild that follows it
+        if (bvh->isFullRefit)
+        {
+            bvh->isRebuildPending = 1;
+        }
+        else
+        {
+            InsertSceneBVHLeaf(scene, bvh, leaf);
+        }
+        return;
+    }
+
+    bvh->nodes[leaf].bounds = bounds;
+    bvh->nodes[leaf].meshCount = meshCount;
+    MarkSceneBVHNodeDirty(bvh, bvh->nodes[leaf].parent);
+}
+
+// lists the node, so the next query brings its leaf in line with its bounds. Once a good part of
+// the leaves has moved, they are all refit in one pass, and only nodes without a leaf are listed
+static void MarkSceneNodeBVHDirty(Scene *scene, unsigned int index)
+{
+    SceneBVH *bvh = &scene->dynamicBVH;
+    if (scene->nodeBVHDirty[index])
+    {
+        return;
+    }
+    if (scene->nodeBVHLeaves[index] != SCENE_NODE_INDEX_NONE && (bvh->isFullRefit || scene->bvhDirtyNodesCount >= bvh->count / 8))
+    {
+        bvh->isFullRefit = 1;
+        return;
+    }
+
+    if (scene->bvhDirtyNodesCount >= scene->bvhDirtyNodesCapacity)
+    {
+        unsigned long capacity = scene->bvhDirtyNodesCapacity == 0 ? 64 : scene->bvhDirtyNodesCapacity * 2;
+        scene->bvhDirtyNodes = ResizeSceneArray(scene, scene->bvhDirtyNodes, scene->bvhDirtyNodesCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+        scene->bvhDirtyNodesCapacity = capacity;
+    }
+    scene->bvhDirtyNodes[scene->bvhDirtyNodesCount++] = scene->nodeIds[index];
+    scene->nodeBVHDirty[index] = 1;
+}
+
+// takes the nodes of the subtree out of dynamicBVH, when they become part of a static subtree
+static void RemoveSceneNodeTreeBVHLeaves(Scene *scene, unsigned int root)
+{
+    // depth first along the tree links, like CompactScene
+    unsigned int index = root;
+    while (1)
+    {
+        if (scene->nodeBVHLeaves[index] != SCENE_NODE_INDEX_NONE)
+        {
+            RemoveSceneBVHLeaf(&scene->dynamicBVH, scene->nodeBVHLeaves[index]);
+            scene->nodeBVHLeaves[index] = SCENE_NODE_INDEX_NONE;
+        }
+        if (scene->nodes[index].firstChild != SCENE_NODE_INDEX_NONE)
+        {
+            index = scene->nodes[index].firstChild;
+            continue;
+        }
+
+        while (index != root && scene->nodes[index].nextSibling == SCENE_NODE_INDEX_NONE)
+        {
+            index = scene->nodeParents[index];
+        }
+        if (index == root)
+        {
+            break;
+        }
+        index = scene->nodes[index].nextSibling;
+    }
+}
+
+typedef struct SceneBVHBuildItem
+{
+    BoundingBox bounds;
+    Vector3 center;
+    unsigned int nodeIndex;
+    unsigned int meshCount;
+} SceneBVHBuildItem;
+
+static int GetSceneBVHBin(SceneBVHBuildItem *item, int axis, float axisMin, float binScale)
+{
+    int bin = (int)(((&item->center.x)[axis] - axisMin) * binScale);
+    return bin < SCENE_BVH_BIN_COUNT ? bin : SCENE_BVH_BIN_COUNT - 1;
+}
+
+// builds the subtree over the items top-down; the tree must have room for all its nodes
+static unsigned int BuildSceneBVHNode(SceneBVH *bvh, SceneBVHBuildItem *items, unsigned long count, int depth)
+{
+    unsigned int index = (unsigned int)bvh->count++;
+    bvh->nodes[index] = (SceneBVHNode){
+        .parent = SCENE_NODE_INDEX_NONE,
+        .child1 = SCENE_NODE_INDEX_NONE,
+        .child2 = SCENE_NODE_INDEX_NONE,
+        .nodeIndex = SCENE_NODE_INDEX_NONE};
+    if (count == 1)
+    {
+        bvh->nodes[index].bounds = items[0].bounds;
+        bvh->nodes[index].nodeIndex = items[0].nodeIndex;
+        bvh->nodes[index].meshCount = items[0].meshCount;
+        return index;
+    }
+
+    // splits along the axis where the item centers spread the most
+    BoundingBox centers = {items[0].center, items[0].center};
+    for (unsigned long i = 1; i < count; i++)
+    {
+        centers = UnionSceneBounds(centers, (BoundingBox){items[i].center, items[i].center});
+    }
+    Vector3 size = Vector3Subtract(centers.max, centers.min);
+    int axis = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+    float axisMin = (&centers.min.x)[axis];
+    float axisSize = (&size.x)[axis];
+
+    unsigned long split = count / 2;
+    if (axisSize > 0.0f && depth < SCENE_BVH_MAX_SAH_DEPTH)
+    {
+        // bins the items by their centers and splits at the bin boundary where the areas of
+        // both sides weighted by their item counts are the smallest
+        BoundingBox binBounds[SCENE_BVH_BIN_COUNT];
+        unsigned long binCounts[SCENE_BVH_BIN_COUNT] = {0};
+        for (int bin = 0; bin < SCENE_BVH_BIN_COUNT; bin++)
+        {
+            binBounds[bin] = SCENE_EMPTY_BOUNDS;
+        }
+        float binScale = SCENE_BVH_BIN_COUNT / axisSize;
+        for (unsigned long i = 0; i < count; i++)
+        {
+            int bin = GetSceneBVHBin(&items[i], axis, axisMin, binScale);
+            binBounds[bin] = UnionSceneBounds(binBounds[bin], items[i].bounds);
+            binCounts[bin]++;
+        }
+
+        float rightCosts[SCENE_BVH_BIN_COUNT];
+        BoundingBox right = SCENE_EMPTY_BOUNDS;
+        unsigned long rightCount = 0;
+        for (int bin = SCENE_BVH_BIN_COUNT - 1; bin > 0; bin--)
+        {
+            right = UnionSceneBounds(right, binBounds[bin]);
+            rightCount += binCounts[bin];
+            rightCosts[bin] = rightCount > 0 ? GetSceneBoundsArea(right) * rightCount : 0.0f;
+        }
+
+        BoundingBox left = SCENE_EMPTY_BOUNDS;
+        unsigned long leftCount = 0;
+        float bestCost = FLT_MAX;
+        int bestBin = 0;
+        for (int bin = 1; bin < SCENE_BVH_BIN_COUNT; bin++)
+        {
+            left = UnionSceneBounds(left, binBounds[bin - 1]);
+            leftCount += binCounts[bin - 1];
+            if (leftCount == 0 || leftCount == count)
+            {
+                continue;
+            }
+            float cost = GetSceneBoundsArea(left) * leftCount + rightCosts[bin];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestBin = bin;
+            }
+        }
+
+        if (bestBin > 0)
+        {
+            unsigned long i = 0;
+            unsigned long j = count;
+            while (i < j)
+            {
+                if (GetSceneBVHBin(&items[i], axis, axisMin, binScale) < bestBin)
+                {
+                    i++;
+                }
+                else
+                {
+                    SceneBVHBuildItem item = items[i];
+                    items[i] = items[--j];
+                    items[j] = item;
+                }
+            }
+            split = i;
+        }
+    }
+
+    unsigned int child1 = BuildSceneBVHNode(bvh, items, split, depth + 1);
+    unsigned int child2 = BuildSceneBVHNode(bvh, items + split, count - split, depth + 1);
+    SceneBVHNode *nodes = bvh->nodes;
+    nodes[index].child1 = child1;
+    nodes[index].child2 = child2;
+    nodes[index].bounds = UnionSceneBounds(nodes[child1].bounds, nodes[child2].bounds);
+    nodes[index].meshCount = nodes[child1].meshCount + nodes[child2].meshCount;
+    nodes[child1].parent = index;
+    bvh->innerArea += GetSceneBoundsArea(nodes[index].bounds);
+    nodes[child2].parent = index;
+    return index;
+}
+
+// replaces the tree by one built over the items
+static void BuildSceneBVH(Scene *scene, SceneBVH *bvh, SceneBVHBuildItem *items, unsigned long count)
+{
+    bvh->root = SCENE_NODE_INDEX_NONE;
+    bvh->firstFree = SCENE_NODE_INDEX_NONE;
+    bvh->count = 0;
+    bvh->innerArea = 0.0;
+    bvh->rebuildCost = 0.0f;
+    bvh->isRebuildPending = 0;
+    bvh->isFullRefit = 0;
+    if (count == 0)
+    {
+        return;
+    }
+
+    unsigned long capacity = 2 * count - 1;
+    if (bvh->capacity < capacity)
+    {
+        ReleaseSceneMemory(scene, bvh->nodes);
+        bvh->nodes = AllocateSceneMemory(scene, capacity * sizeof(SceneBVHNode));
+        bvh->capacity = capacity;
+    }
+    bvh->root = BuildSceneBVHNode(bvh, items, count, 0);
+    bvh->rebuildCost = SCENE_BVH_REBUILD_FACTOR * GetSceneBVHCost(bvh);
+}
+
+// builds staticBVH from scratch over the nodes with bounds in static subtrees
+static void RebuildSceneStaticBVH(Scene *scene)
+{
+    // nodes outside static subtrees with bounds are in dynamicBVH already, or will be at the
+    // next transform update
+    SceneBVHBuildItem *items = AllocateSceneMemory(scene, scene->nodesCount * sizeof(SceneBVHBuildItem));
+    unsigned long count = 0;
+    for (unsigned int i = 0; i < scene->nodesCount; i++)
+    {
+        BoundingBox bounds = scene->nodeBounds[i];
+        if (scene->nodeIds[i] == SCENE_NODE_INDEX_NONE || scene->nodeModels[i] < 0 || bounds.min.x > bounds.max.x ||
+            scene->nodeBVHLeaves[i] != SCENE_NODE_INDEX_NONE || !IsSceneNodeInStaticTree(scene, i))
+        {
+            continue;
+        }
+
+        items[count++] = (SceneBVHBuildItem){
+            .bounds = bounds,
+            .center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f),
+            .nodeIndex = i,
+            .meshCount = scene->models[scene->nodeModels[i]].model.meshCount};
+    }
+
+    BuildSceneBVH(scene, &scene->staticBVH, items, count);
+    scene->isStaticBVHDirty = 0;
+    ReleaseSceneMemory(scene, items);
+}
+
+// builds dynamicBVH again over its current leaves
+static void RebuildSceneDynamicBVH(Scene *scene)
+{
+    SceneBVH *bvh = &scene->dynamicBVH;
+    SceneBVHBuildItem *items = AllocateSceneMemory(scene, scene->nodesCount * sizeof(SceneBVHBuildItem));
+    unsigned long count = 0;
+    for (unsigned int i = 0; i < scene->nodesCount; i++)
+    {
+        unsigned int leaf = scene->nodeBVHLeaves[i];
+        if (leaf == SCENE_NODE_INDEX_NONE)
+        {
+            continue;
+        }
+
+        BoundingBox bounds = bvh->nodes[leaf].bounds;
+        items[count++] = (SceneBVHBuildItem){
+            .bounds = bounds,
+            .center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f),
+            .nodeIndex = i,
+            .meshCount = bvh->nodes[leaf].meshCount};
+    }
+
+    BuildSceneBVH(scene, bvh, items, count);
+    for (unsigned int i = 0; i < bvh->count; i++)
+    {
+        if (bvh->nodes[i].child1 == SCENE_NODE_INDEX_NONE)
+        {
+            scene->nodeBVHLeaves[bvh->nodes[i].nodeIndex] = i;
+        }
+    }
+    ReleaseSceneMemory(scene, items);
+}
+
+// brings both trees up to date with the node bounds; called by the queries, so scenes that
+// never query pay nothing but the listing of their moved nodes
+static void UpdateSceneBVH(Scene *scene)
+{
+    if (scene->isStaticBVHDirty)
+    {
+        RebuildSceneStaticBVH(scene);
+    }
+
+    // with many nodes listed, new leaves are left to a rebuild rather than inserted one by one
+    SceneBVH *bvh = &scene->dynamicBVH;
+    if (scene->bvhDirtyNodesCount > bvh->count / 8)
+    {
+        bvh->isFullRefit = 1;
+    }
+    if (bvh->isFullRefit)
+    {
+        for (unsigned int i = 0; i < scene->nodesCount; i++)
+        {
+            unsigned int leaf = scene->nodeBVHLeaves[i];
+            if (leaf != SCENE_NODE_INDEX_NONE)
+            {
+                bvh->nodes[leaf].bounds = scene->nodeBounds[i];
+            }
+        }
+    }
+    for (unsigned long i = 0; i < scene->bvhDirtyNodesCount; i++)
+    {
+        // released ids are skipped; a reused id just brings its new node up to date
+        unsigned int id = scene->bvhDirtyNodes[i];
+        if (scene->nodeIdGenerations[id] <= 0)
+        {
+            continue;
+        }
+        unsigned int index = scene->nodeIdIndices[id];
+        scene->nodeBVHDirty[index] = 0;
+        // nodes with pending transforms are listed again once their bounds are final, and nodes
+        // that became part of a static subtree since are in staticBVH
+        if ((scene->nodeTRSDirty[index] && scene->nodeModels[index] >= 0) ||
+            (scene->staticNodeCount > 0 && IsSceneNodeInStaticTree(scene, index)))
+        {
+            continue;
+        }
+        UpdateSceneNodeBVHLeaf(scene, index);
+    }
+    scene->bvhDirtyNodesCount = 0;
+
+    // a tree grown from nothing by insertions is rebuilt right away, which also lays it out in
+    // depth first order; the rebuild only needs the leaves, so there's nothing to refit then
+    if (bvh->isRebuildPending)
+    {
+        RebuildSceneDynamicBVH(scene);
+    }
+    else
+    {
+        RefitSceneBVH(bvh);
+        if (bvh->root != SCENE_NODE_INDEX_NONE && GetSceneBVHCost(bvh) > bvh->rebuildCost)
+        {
+            RebuildSceneDynamicBVH(scene);
+        }
+    }
+
+    // a traversal never holds more entries than a tree has nodes
+    unsigned long stackCapacity = scene->staticBVH.count > scene->dynamicBVH.count ? scene->staticBVH.count : scene->dynamicBVH.count;
+    if (scene->bvhStackCapacity < stackCapacity)
+    {
+        ReleaseSceneMemory(scene, scene->bvhStack);
+        scene->bvhStack = AllocateSceneMemory(scene, stackCapacity * 2 * sizeof(SceneBVHStackEntry));
+        scene->bvhStackCapacity = stackCapacity * 2;
+    }
+}
+
+// entry distance of the ray into the box, in units of the ray direction, or -1 if the ray misses
+// it before maxDistance; axisOut is set to the axis of the entered face, -1 if the ray starts inside
+static float GetSceneRayBoxDistance(Ray ray, Vector3 inverseDirection, BoundingBox box, float maxDistance, int *axisOut)
+{
+    float entry = 0.0f;
+    float exit = maxDistance;
+    int axis = -1;
+    for (int i = 0; i < 3; i++)
+    {
+        float origin = (&ray.position.x)[i];
+        float t1 = ((&box.min.x)[i] - origin) * (&inverseDirection.x)[i];
+        float t2 = ((&box.max.x)[i] - origin) * (&inverseDirection.x)[i];
+        float tEntry = t1 < t2 ? t1 : t2;
+        float tExit = t1 < t2 ? t2 : t1;
+        if (tEntry > entry)
+        {
+            entry = tEntry;
+            axis = i;
+        }
+        if (tExit < exit)
+        {
+            exit = tExit;
+        }
+    }
+
+    *axisOut = axis;
+    return entry <= exit ? entry : -1.0f;
+}
+
+// finds the nearest leaf the ray hits closer than bestDistance, visiting the nearer child first
+static void RaycastSceneBVH(Scene *scene, SceneBVH *bvh, Ray ray, Vector3 inverseDirection, float *bestDistance, unsigned int *bestIndex, int *bestAxis)
+{
+    SceneBVHNode *nodes = bvh->nodes;
+    int axis;
+    if (bvh->root == SCENE_NODE_INDEX_NONE)
+    {
+        return;
+    }
+    float distance = GetSceneRayBoxDistance(ray, inverseDirection, nodes[bvh->root].bounds, *bestDistance, &axis);
+    if (distance < 0.0f)
+    {
+        return;
+    }
+
+    SceneBVHStackEntry *stack = scene->bvhStack;
+    unsigned long stackCount = 0;
+    stack[stackCount++] = (SceneBVHStackEntry){bvh->root, distance};
+    while (stackCount > 0)
+    {
+        SceneBVHStackEntry entry = stack[--stackCount];
+        if (entry.distance >= *bestDistance)
+        {
+            continue;
+        }
+
+        SceneBVHNode *node = &nodes[entry.node];
+        if (node->child1 == SCENE_NODE_INDEX_NONE)
+        {
+            GetSceneRayBoxDistance(ray, inverseDirection, node->bounds, *bestDistance, &axis);
+            *bestDistance = entry.distance;
+            *bestIndex = node->nodeIndex;
+            *bestAxis = axis;
+            continue;
+        }
+
+        float distance1 = GetSceneRayBoxDistance(ray, inverseDirection, nodes[node->child1].bounds, *bestDistance, &axis);
+        float distance2 = GetSceneRayBoxDistance(ray, inverseDirection, nodes[node->child2].bounds, *bestDistance, &axis);
+        SceneBVHStackEntry entry1 = {node->child1, distance1};
+        SceneBVHStackEntry entry2 = {node->child2, distance2};
+        if (distance1 > distance2)
+        {
+            SceneBVHStackEntry swap = entry1;
+            entry1 = entry2;
+            entry2 = swap;
+        }
+        // the farther child goes first, so the nearer one is popped next
+        if (entry2.distance >= 0.0f)
+        {
+            stack[stackCount++] = entry2;
+        }
+        if (entry1.distance >= 0.0f)
+        {
+            stack[stackCount++] = entry1;
+        }
+    }
+}
+
+RayCollision GetRayCollisionScene(SceneId sceneId, Ray ray, SceneNodeId *sceneNodeId)
+{
+    RayCollision collision = {0};
+    if (sceneNodeId)
+    {
+        *sceneNodeId = (SceneNodeId){0};
+    }
+    Scene *scene = GetScene(sceneId);
+    if (!scene)
+    {
+        return collision;
+    }
+
+    UpdateSceneBVH(scene);
+    Vector3 inverseDirection = {1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z};
+    float bestDistance = FLT_MAX;
+    unsigned int bestIndex = SCENE_NODE_INDEX_NONE;
+    int bestAxis = -1;
+    RaycastSceneBVH(scene, &scene->staticBVH, ray, inverseDirection, &bestDistance, &bestIndex, &bestAxis);
+    RaycastSceneBVH(scene, &scene->dynamicBVH, ray, inverseDirection, &bestDistance, &bestIndex, &bestAxis);
+    if (bestIndex == SCENE_NODE_INDEX_NONE)
+    {
+        return collision;
+    }
+
+    collision.hit = true;
+    collision.distance = bestDistance;
+    collision.point = Vector3Add(ray.position, Vector3Scale(ray.direction, bestDistance));
+    if (bestAxis >= 0)
+    {
+        (&collision.normal.x)[bestAxis] = (&ray.direction.x)[bestAxis] > 0.0f ? -1.0f : 1.0f;
+    }
+    if (sceneNodeId)
+    {
+        *sceneNodeId = GetSceneNodeIdOfId(scene, scene->nodeIds[bestIndex]);
+    }
+    return collision;
+}
+
+// adds the nodes of the tree whose bounds overlap the box, and the sphere if radius isn't negative
+static int FindSceneBVHOverlaps(Scene *scene, SceneBVH *bvh, BoundingBox box, Vector3 center, float radius, SceneNodeId *sceneNodeIds, int maxCount, int count)
+{
+    if (bvh->root == SCENE_NODE_INDEX_NONE)
+    {
+        return count;
+    }
+
+    SceneBVHNode *nodes = bvh->nodes;
+    SceneBVHStackEntry *stack = scene->bvhStack;
+    unsigned long stackCount = 0;
+    stack[stackCount++].node = bvh->root;
+    while (stackCount > 0)
+    {
+        SceneBVHNode *node = &nodes[stack[--stackCount].node];
+        if (!CheckCollisionBoxes(node->bounds, box))
+        {
+            continue;
+        }
+        if (node->child1 != SCENE_NODE_INDEX_NONE)
+        {
+            stack[stackCount++].node = node->child2;
+            stack[stackCount++].node = node->child1;
+            continue;
+        }
+
+        if (radius >= 0.0f && !CheckCollisionBoxSphere(node->bounds, center, radius))
+        {
+            continue;
+        }
+        if (count < maxCount)
+        {
+            sceneNodeIds[count] = GetSceneNodeIdOfId(scene, scene->nodeIds[node->nodeIndex]);
+        }
+        count++;
+    }
+
+    return count;
+}
+
+int FindSceneNodesInBox(SceneId sceneId, BoundingBox box, SceneNodeId *sceneNodeIds, int maxCount)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene)
+    {
+        return 0;
+    }
+
+    UpdateSceneBVH(scene);
+    int count = FindSceneBVHOverlaps(scene, &scene->staticBVH, box, (Vector3){0, 0, 0}, -1.0f, sceneNodeIds, maxCount, 0);
+    return FindSceneBVHOverlaps(scene, &scene->dynamicBVH, box, (Vector3){0, 0, 0}, -1.0f, sceneNodeIds, maxCount, count);
+}
+
+int FindSceneNodesInSphere(SceneId sceneId, Vector3 center, float radius, SceneNodeId *sceneNodeIds, int maxCount)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene)
+    {
+        return 0;
+    }
+
+    // the sphere's box narrows the tree down, the leaves are tested against the sphere itself
+    UpdateSceneBVH(scene);
+    Vector3 extent = {radius, radius, radius};
+    BoundingBox box = {Vector3Subtract(center, extent), Vector3Add(center, extent)};
+    int count = FindSceneBVHOverlaps(scene, &scene->staticBVH, box, center, radius, sceneNodeIds, maxCount, 0);
+    return FindSceneBVHOverlaps(scene, &scene->dynamicBVH, box, center, radius, sceneNodeIds, maxCount, count);
+}
+
+void UpdateSceneSpatialIndex(SceneId sceneId)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene)
+    {
+        return;
+    }
+
+    UpdateSceneBVH(scene);
+}
+
+// inserts the node at the front of the parent's child list; the node must not have a parent
+static void LinkSceneNodeToParent(Scene *scene, unsigned int index, unsigned int parentIndex)
+{
+    SceneNode *node = &scene->nodes[index];
+    SceneNode *parentNode = &scene->nodes[parentIndex];
+    node->prevSibling = SCENE_NODE_INDEX_NONE;
+    node->nextSibling = parentNode->firstChild;
+    if (parentNode->firstChild != SCENE_NODE_INDEX_NONE)
+    {
+        scene->nodes[parentNode->firstChild].prevSibling = index;
+    }
+    parentNode->firstChild = index;
+    scene->nodeParents[index] = parentIndex;
+    MarkSceneSubtreeBoundsDirty(scene, parentIndex);
+
+    if (node->nameId != 0)
+    {
+        unsigned int id = scene->nodeIds[index];
+        RemoveSceneNameIndexEntry(scene, SCENE_NODE_INDEX_NONE, node->nameId, id, SCENE_NAME_CHAIN_PARENT);
+        AddSceneNameIndexEntry(scene, scene->nodeIds[parentIndex], node->nameId, id, SCENE_NAME_CHAIN_PARENT);
+    }
+}
+
+void ReserveSceneNodes(SceneId sceneId, unsigned long count)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene)
+    {
+        return;
+    }
+
+    if (scene->nodesCount + count > scene->nodesCapacity)
+    {
+        ResizeSceneNodeArrays(scene, scene->nodesCount + count);
+    }
+    if (scene->nodeIdsCount + count > scene->nodeIdsCapacity)
+    {
+        ResizeSceneNodeIdArrays(scene, scene->nodeIdsCount + count);
+    }
+}
+
+int AcquireSceneNodesEx(SceneId sceneId, int count, SceneNodeId parentSceneNodeId, SceneNodeId *sceneNodeIds)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene || count <= 0)
+    {
+        return 0;
+    }
+
+    unsigned int parentIndex = SCENE_NODE_INDEX_NONE;
+    if (parentSceneNodeId.generation != 0)
+    {
+        Scene *parentScene;
+        if (!GetSceneNode(parentSceneNodeId, &parentScene, &parentIndex) || parentScene != scene)
+        {
+            TraceLog(LOG_WARNING, "AcquireSceneNodesEx: parent must be a valid node of the same scene");
+            return 0;
+        }
+    }
+
+    if (scene->nodeIdsCount + count > scene->nodeIdsCapacity)
+    {
+        unsigned long capacity = scene->nodeIdsCapacity == 0 ? 8 : scene->nodeIdsCapacity * 2;
+        ResizeSceneNodeIdArrays(scene, capacity < scene->nodeIdsCount + count ? scene->nodeIdsCount + count : capacity);
+    }
+
+    // released slots are reused first
+    int acquired = 0;
+    while (acquired < count && scene->firstFree != SCENE_NODE_INDEX_NONE)
+    {
+        unsigned int index = scene->firstFree;
+        scene->firstFree = scene->nodes[index].nextSibling;
+        InitSceneNodes(scene, index, 1);
+        sceneNodeIds[acquired++] = AssignSceneNodeId(scene, sceneId, index);
+    }
+
+    // the rest is appended as one block with at most one reallocation
+    unsigned long blockCount = count - acquired;
+    if (blockCount > 0)
+    {
+        unsigned long required = scene->nodesCount + blockCount;
+        if (required > scene->nodesCapacity)
+        {
+            unsigned long capacity = scene->nodesCapacity == 0 ? 8 : scene->nodesCapacity * 2;
+            ResizeSceneNodeArrays(scene, capacity < required ? required : capacity);
+        }
+
+        unsigned int index = scene->nodesCount;
+        scene->nodesCount += blockCount;
+        InitSceneNodes(scene, index, blockCount);
+        for (unsigned long i = 0; i < blockCount; i++)
+        {
+            sceneNodeIds[acquired++] = AssignSceneNodeId(scene, sceneId, index + i);
+        }
+    }
+
+    // the node storage may have moved, so the parent is only looked at now
+    if (parentIndex != SCENE_NODE_INDEX_NONE)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            LinkSceneNodeToParent(scene, scene->nodeIdIndices[sceneNodeIds[i].id], parentIndex);
+        }
+    }
+
+    scene->isHierarchyOrderDirty = 1;
+    return count;
+}
+
+int AcquireSceneNodes(SceneId sceneId, int count, SceneNodeId *sceneNodeIds)
+{
+    return AcquireSceneNodesEx(sceneId, count, (SceneNodeId){0}, sceneNodeIds);
+}
+
+SceneNodeId AcquireSceneNode(SceneId sceneId)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene)
+    {
+        return (SceneNodeId){0};
+    }
+
+    unsigned int index;
+    if (scene->firstFree != SCENE_NODE_INDEX_NONE)
+    {
+        index = scene->firstFree;
+        scene->firstFree = scene->nodes[index].nextSibling;
+    }
+    else
+    {
+        if (scene->nodesCount >= scene->nodesCapacity)
+        {
+            ResizeSceneNodeArrays(scene, scene->nodesCapacity == 0 ? 8 : scene->nodesCapacity * 2);
+        }
+        index = scene->nodesCount++;
+    }
+    if (scene->firstFreeId == SCENE_NODE_INDEX_NONE && scene->nodeIdsCount >= scene->nodeIdsCapacity)
+    {
+        ResizeSceneNodeIdArrays(scene, scene->nodeIdsCapacity == 0 ? 8 : scene->nodeIdsCapacity * 2);
+    }
+
+    scene->isHierarchyOrderDirty = 1;
+    InitSceneNodes(scene, index, 1);
+
+    return AssignSceneNodeId(scene, sceneId, index);
+}
+
+// marks the node and its subtree dirty; already dirty subtrees are skipped,
+// so repeated modifications of a node within a frame walk its subtree only once.
+// Static child subtrees keep their baked transforms and are not marked. The pre-order walk
+// follows the tree links like ReleaseSceneNodeTree, so deep chains need no recursion
+static void MarkSceneNodeTRSDirty(Scene *scene, unsigned int root)
+{
+    if (scene->nodeTRSDirty[root])
+    {
+        return;
+    }
+
+    scene->nodeTRSDirty[root] = 1;
+    unsigned int index = root;
+    unsigned int child = scene->nodes[root].firstChild;
+    while (1)
+    {
+        // child is the next candidate among the children of index
+        while (child != SCENE_NODE_INDEX_NONE && (scene->nodeTRSDirty[child] || scene->nodeStatic[child]))
+        {
+            child = scene->nodes[child].nextSibling;
+        }
+        if (child != SCENE_NODE_INDEX_NONE)
+        {
+            scene->nodeTRSDirty[child] = 1;
+            index = child;
+            child = scene->nodes[index].firstChild;
+            continue;
+        }
+
+        // the children of index are done; go on with its next sibling
+        if (index == root)
+        {
+            break;
+        }
+        child = scene->nodes[index].nextSibling;
+        index = scene->nodeParents[index];
+    }
+}
+
+// returns 1 if the node or one of its ancestors is static
+static int IsSceneNodeInStaticTree(Scene *scene, unsigned int index)
+{
+    for (; index != SCENE_NODE_INDEX_NONE; index = scene->nodeParents[index])
+    {
+        if (scene->nodeStatic[index])
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// resolves the id to its node slot; returns 0 if the id is stale
+static SceneNode *GetSceneNode(SceneNodeId sceneNodeId, Scene **sceneOut, unsigned int *indexOut)
+{
+    Scene *scene = GetScene(sceneNodeId.sceneId);
+    if (!scene)
+    {
+        return 0;
+    }
+
+    // released ids keep their negated generation, and their nodeIdIndices entry links the free list
+    if (sceneNodeId.generation <= 0 || sceneNodeId.id >= scene->nodeIdsCount || scene->nodeIdGenerations[sceneNodeId.id] != sceneNodeId.generation)
+    {
+        return 0;
+    }
+
+    unsigned int index = scene->nodeIdIndices[sceneNodeId.id];
+    if (sceneOut)
+        *sceneOut = scene;
+    if (indexOut)
+        *indexOut = index;
+
+    return &scene->nodes[index];
+}
+
+// validates a node of a batch and resolves its slot; the scene is only looked up again when
+// it differs from the one of the previous node, which is kept in batchSceneId and batchScene
+static int IsBatchSceneNodeValid(SceneNodeId sceneNodeId, SceneId *batchSceneId, Scene **batchScene, unsigned int *indexOut)
+{
+    if (sceneNodeId.sceneId.id != batchSceneId->id || sceneNodeId.sceneId.generation != batchSceneId->generation || !*batchScene)
+    {
+        *batchSceneId = sceneNodeId.sceneId;
+        *batchScene = GetScene(sceneNodeId.sceneId);
+    }
+
+    Scene *scene = *batchScene;
+    if (!scene || sceneNodeId.generation <= 0 || sceneNodeId.id >= scene->nodeIdsCount || scene->nodeIdGenerations[sceneNodeId.id] != sceneNodeId.generation)
+    {
+        return 0;
+    }
+
+    *indexOut = scene->nodeIdIndices[sceneNodeId.id];
+    return 1;
+}
+
+int IsSceneNodeValid(SceneNodeId sceneNodeId)
+{
+    return GetSceneNode(sceneNodeId, 0, 0) != 0;
+}
+
+// resolves a packed handle with a single tag comparison; returns 0 if the handle is stale
+static Scene *GetSceneOfNodeHandle(SceneNodeHandle handle, unsigned int *indexOut)
+{
+    unsigned long sceneIndex = (unsigned long)(handle >> 56);
+    unsigned int id = (unsigned int)handle;
+    unsigned int tag = (unsigned int)(handle >> 32);
+    // released ids have tag 0, which is also the tag of the invalid handle 0
+    if (tag == 0 || sceneIndex >= scenesCount)
+    {
+        return 0;
+    }
+
+    Scene *scene = &scenes[sceneIndex];
+    if (id >= scene->nodeIdsCount || scene->nodeHandleTags[id] != tag)
+    {
+        return 0;
+    }
+
+    *indexOut = scene->nodeIdIndices[id];
+    return scene;
+}
+
+SceneNodeHandle GetSceneNodeHandle(SceneNodeId sceneNodeId)
+{
+    Scene *scene;
+    if (!GetSceneNode(sceneNodeId, &scene, 0))
+    {
+        return 0;
+    }
+
+    return ((SceneNodeHandle)scene->nodeHandleTags[sceneNodeId.id] << 32) | (SceneNodeHandle)sceneNodeId.id;
+}
+
+SceneNodeId GetSceneNodeIdFromHandle(SceneNodeHandle handle)
+{
+    unsigned int index;
+    Scene *scene = GetSceneOfNodeHandle(handle, &index);
+    if (!scene)
+    {
+        return (SceneNodeId){0};
+    }
+
+    SceneId sceneId = {(unsigned long)(handle >> 56), scene->generation};
+    unsigned int id = (unsigned int)handle;
+    return (SceneNodeId){sceneId, id, scene->nodeIdGenerations[id]};
+}
+
+int IsSceneNodeHandleValid(SceneNodeHandle handle)
+{
+    unsigned int index;
+    return GetSceneOfNodeHandle(handle, &index) != 0;
+}
+
+// removes the node from its parent's child list in constant time
+static void UnlinkSceneNodeFromParent(Scene *scene, unsigned int index)
+{
+    unsigned int parentIndex = scene->nodeParents[index];
+    if (parentIndex == SCENE_NODE_INDEX_NONE)
+    {
+        return;
+    }
+
+    SceneNode *node = &scene->nodes[index];
+    if (node->prevSibling != SCENE_NODE_INDEX_NONE)
+    {
+        scene->nodes[node->prevSibling].nextSibling = node->nextSibling;
+    }
+    else
+    {
+        scene->nodes[parentIndex].firstChild = node->nextSibling;
+    }
+    if (node->nextSibling != SCENE_NODE_INDEX_NONE)
+    {
+        scene->nodes[node->nextSibling].prevSibling = node->prevSibling;
+    }
+
+    node->prevSibling = SCENE_NODE_INDEX_NONE;
+    node->nextSibling = SCENE_NODE_INDEX_NONE;
+    scene->nodeParents[index] = SCENE_NODE_INDEX_NONE;
+    MarkSceneSubtreeBoundsDirty(scene, parentIndex);
+
+    if (node->nameId != 0)
+    {
+        unsigned int id = scene->nodeIds[index];
+        RemoveSceneNameIndexEntry(scene, scene->nodeIds[parentIndex], node->nameId, id, SCENE_NAME_CHAIN_PARENT);
+        AddSceneNameIndexEntry(scene, SCENE_NODE_INDEX_NONE, node->nameId, id, SCENE_NAME_CHAIN_PARENT);
+    }
+}
+
+void SetSceneNodeParent(SceneNodeId sceneNodeId, SceneNodeId parentSceneNodeId)
+{
+    if (parentSceneNodeId.sceneId.id != sceneNodeId.sceneId.id)
+    {
+        TraceLog(LOG_WARNING, "SetSceneNodeParent: scene node and parent must be in the same scene");
+        return;
+    }
+
+    Scene *scene;
+    unsigned int index;
+    unsigned int parentIndex;
+    if (!GetSceneNode(sceneNodeId, &scene, &index) || !GetSceneNode(parentSceneNodeId, 0, &parentIndex))
+    {
+        return;
+    }
+
+    // nodes moving into a static subtree leave dynamicBVH; any move into or out of one
+    // changes the nodes of staticBVH
+    int wasStatic = scene->staticNodeCount > 0 && IsSceneNodeInStaticTree(scene, index);
+    UnlinkSceneNodeFromParent(scene, index);
+    LinkSceneNodeToParent(scene, index, parentIndex);
+    if (scene->staticNodeCount > 0 && IsSceneNodeInStaticTree(scene, parentIndex))
+    {
+        RemoveSceneNodeTreeBVHLeaves(scene, index);
+        scene->isStaticBVHDirty = 1;
+    }
+    else if (wasStatic)
+    {
+        scene->isStaticBVHDirty = 1;
+    }
+    MarkSceneNodeTRSDirty(scene, index);
+    scene->isHierarchyOrderDirty = 1;
+}
+
+// frees the node and its descendants in one post-order pass that follows the tree links,
+// so neither recursion nor a stack is needed; the node must already be unlinked from its parent.
+// The freed slots are chained up and put on the free list at once
+static void ReleaseSceneNodeTree(Scene *scene, unsigned int root)
+{
+    unsigned int freeHead = SCENE_NODE_INDEX_NONE;
+    unsigned int freeTail = SCENE_NODE_INDEX_NONE;
+
+    unsigned int index = root;
+    while (scene->nodes[index].firstChild != SCENE_NODE_INDEX_NONE)
+    {
+        index = scene->nodes[index].firstChild;
+    }
+
+    while (1)
+    {
+        // all children of index are released at this point
+        SceneNode *node = &scene->nodes[index];
+        unsigned int nextSibling = node->nextSibling;
+        unsigned int parentIndex = scene->nodeParents[index];
+
+        if (node->nameId != 0)
+        {
+            SetSceneNodeNameId(scene, index, 0);
+        }
+        if (node->firstComponent != SCENE_NODE_INDEX_NONE)
+        {
+            RemoveSceneNodeComponents(scene, index);
+        }
+        if (scene->nodeBVHLeaves[index] != SCENE_NODE_INDEX_NONE)
+        {
+            RemoveSceneBVHLeaf(&scene->dynamicBVH, scene->nodeBVHLeaves[index]);
+            scene->nodeBVHLeaves[index] = SCENE_NODE_INDEX_NONE;
+        }
+        if (scene->nodeStatic[index])
+        {
+            scene->isStaticBVHDirty = 1;
+            scene->staticNodeCount--;
+        }
+
+        // a negative generation marks the id as released
+        unsigned int id = scene->nodeIds[index];
+        scene->nodeIdGenerations[id] = -scene->nodeIdGenerations[id];
+        scene->nodeHandleTags[id] = 0;
+        scene->nodeIdIndices[id] = scene->firstFreeId;
+        scene->firstFreeId = id;
+        scene->nodeIds[index] = SCENE_NODE_INDEX_NONE;
+        scene->nodeModels[index] = -1;
+        scene->nodeParents[index] = SCENE_NODE_INDEX_NONE;
+        node->firstChild = SCENE_NODE_INDEX_NONE;
+        node->prevSibling = SCENE_NODE_INDEX_NONE;
+        node->nextSibling = freeHead;
+        freeHead = index;
+        if (freeTail == SCENE_NODE_INDEX_NONE)
+        {
+            freeTail = index;
+        }
+
+        if (index == root)
+        {
+            break;
+        }
+
+        if (nextSibling != SCENE_NODE_INDEX_NONE)
+        {
+            index = nextSibling;
+            while (scene->nodes[index].firstChild != SCENE_NODE_INDEX_NONE)
+            {
+                index = scene->nodes[index].firstChild;
+            }
+        }
+        else
+        {
+            index = parentIndex;
+        }
+    }
+
+    scene->nodes[freeTail].nextSibling = scene->firstFree;
+    scene->firstFree = freeHead;
+    scene->isHierarchyOrderDirty = 1;
+}
+
+void ReleaseSceneNodeSubtree(SceneNodeId sceneNodeId)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return;
+    }
+
+    if (scene->staticNodeCount > 0 && IsSceneNodeInStaticTree(scene, index))
+    {
+        scene->isStaticBVHDirty = 1;
+    }
+    UnlinkSceneNodeFromParent(scene, index);
+    ReleaseSceneNodeTree(scene, index);
+}
+
+// releases a scene node (destroy) and all its children
+void ReleaseSceneNode(SceneNodeId sceneNodeId)
+{
+    ReleaseSceneNodeSubtree(sceneNodeId);
+}
+
+// replaces the array by a new one of count elements, where element i is array[order[i]]
+static void *PermuteSceneArray(Scene *scene, void *array, unsigned long elementSize, const unsigned int *order, unsigned long count)
+{
+    unsigned char *source = array;
+    unsigned char *permuted = AllocateSceneMemory(scene, count * elementSize);
+    for (unsigned long i = 0; i < count; i++)
+    {
+        memcpy(permuted + i * elementSize, source + order[i] * elementSize, elementSize);
+    }
+    ReleaseSceneMemory(scene, array);
+    return permuted;
+}
+
+static unsigned int RemapSceneNodeIndex(const unsigned int *remap, unsigned int index)
+{
+    return index == SCENE_NODE_INDEX_NONE ? SCENE_NODE_INDEX_NONE : remap[index];
+}
+
+void CompactScene(SceneId sceneId)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene || scene->nodesCount == 0)
+    {
+        return;
+    }
+
+    // order[slot] = old slot of the node that moves there; every root is followed by its
+    // subtree in depth first order, walked along the tree links
+    unsigned int *order = AllocateSceneMemory(scene, scene->nodesCount * sizeof(unsigned int));
+    unsigned long liveCount = 0;
+    for (unsigned int root = 0; root < scene->nodesCount; root++)
+    {
+        if (scene->nodeIds[root] == SCENE_NODE_INDEX_NONE || scene->nodeParents[root] != SCENE_NODE_INDEX_NONE)
+        {
+            continue;
+        }
+
+        unsigned int index = root;
+        while (1)
+        {
+            order[liveCount++] = index;
+            if (scene->nodes[index].firstChild != SCENE_NODE_INDEX_NONE)
+            {
+                index = scene->nodes[index].firstChild;
+                continue;
+            }
+
+            while (index != root && scene->nodes[index].nextSibling == SCENE_NODE_INDEX_NONE)
+            {
+                index = scene->nodeParents[index];
+            }
+            if (index == root)
+            {
+                break;
+            }
+            index = scene->nodes[index].nextSibling;
+        }
+    }
+
+    FreeSceneHierarchyOrder(scene);
+    if (liveCount == 0)
+    {
+        ReleaseSceneMemory(scene, order);
+        FreeSceneNodeArrays(scene);
+        return;
+    }
+
+    unsigned int *remap = AllocateSceneMemory(scene, scene->nodesCount * sizeof(unsigned int));
+    for (unsigned long i = 0; i < liveCount; i++)
+    {
+        remap[order[i]] = (unsigned int)i;
+    }
+
+    scene->nodes = PermuteSceneArray(scene, scene->nodes, sizeof(SceneNode), order, liveCount);
+    scene->nodeIds = PermuteSceneArray(scene, scene->nodeIds, sizeof(unsigned int), order, liveCount);
+    scene->nodePositions = PermuteSceneArray(scene, scene->nodePositions, sizeof(Vector3), order, liveCount);
+    scene->nodeRotations = PermuteSceneArray(scene, scene->nodeRotations, sizeof(Vector3), order, liveCount);
+    scene->nodeRotationsQ = PermuteSceneArray(scene, scene->nodeRotationsQ, sizeof(Quaternion), order, liveCount);
+    scene->nodeRotationModes = PermuteSceneArray(scene, scene->nodeRotationModes, sizeof(unsigned char), order, liveCount);
+    scene->nodeTransformKinds = PermuteSceneArray(scene, scene->nodeTransformKinds, sizeof(unsigned char), order, liveCount);
+    scene->nodeScales = PermuteSceneArray(scene, scene->nodeScales, sizeof(Vector3), order, liveCount);
+    scene->nodeLocalToWorld = PermuteSceneArray(scene, scene->nodeLocalToWorld, sizeof(SceneAffineMatrix), order, liveCount);
+    scene->nodeParents = PermuteSceneArray(scene, scene->nodeParents, sizeof(unsigned int), order, liveCount);
+    scene->nodeModels = PermuteSceneArray(scene, scene->nodeModels, sizeof(int), order, liveCount);
+    scene->nodeTRSDirty = PermuteSceneArray(scene, scene->nodeTRSDirty, sizeof(char), order, liveCount);
+    scene->nodeStatic = PermuteSceneArray(scene, scene->nodeStatic, sizeof(char), order, liveCount);
+    scene->nodeChanged = PermuteSceneArray(scene, scene->nodeChanged, sizeof(char), order, liveCount);
+    scene->nodeBounds = PermuteSceneArray(scene, scene->nodeBounds, sizeof(BoundingBox), order, liveCount);
+    scene->nodeSubtreeBounds = PermuteSceneArray(scene, scene->nodeSubtreeBounds, sizeof(BoundingBox), order, liveCount);
+    scene->nodeSubtreeMeshCounts = PermuteSceneArray(scene, scene->nodeSubtreeMeshCounts, sizeof(unsigned int), order, liveCount);
+    scene->nodeSubtreeBoundsDirty = PermuteSceneArray(scene, scene->nodeSubtreeBoundsDirty, sizeof(char), order, liveCount);
+    scene->nodeBVHLeaves = PermuteSceneArray(scene, scene->nodeBVHLeaves, sizeof(unsigned int), order, liveCount);
+    scene->nodeBVHDirty = PermuteSceneArray(scene, scene->nodeBVHDirty, sizeof(char), order, liveCount);
+
+    for (unsigned long i = 0; i < liveCount; i++)
+    {
+        SceneNode *node = &scene->nodes[i];
+        node->nextSibling = RemapSceneNodeIndex(remap, node->nextSibling);
+        node->prevSibling = RemapSceneNodeIndex(remap, node->prevSibling);
+        node->firstChild = RemapSceneNodeIndex(remap, node->firstChild);
+        scene->nodeParents[i] = RemapSceneNodeIndex(remap, scene->nodeParents[i]);
+        scene->nodeIdIndices[scene->nodeIds[i]] = (unsigned int)i;
+        if (scene->nodeBVHLeaves[i] != SCENE_NODE_INDEX_NONE)
+        {
+            scene->dynamicBVH.nodes[scene->nodeBVHLeaves[i]].nodeIndex = (unsigned int)i;
+        }
+    }
+    // static leaves are found again by the next rebuild
+    if (scene->staticBVH.root != SCENE_NODE_INDEX_NONE)
+    {
+        scene->isStaticBVHDirty = 1;
+    }
+
+    ReleaseSceneMemory(scene, remap);
+    ReleaseSceneMemory(scene, order);
+    scene->nodesCount = liveCount;
+    scene->nodesCapacity = liveCount;
+    scene->firstFree = SCENE_NODE_INDEX_NONE;
+}
+
+// adds copies of the components after key in the chain to the node, keeping their order
+static void CloneSceneNodeComponents(Scene *scene, unsigned int key, unsigned int index)
+{
+    if (key == SCENE_NODE_INDEX_NONE)
+    {
+        return;
+    }
+
+    // components are added at the front of the chain, so the rest of it goes first
+    unsigned char definitionId = (unsigned char)(key >> 24);
+    unsigned int slot = key & SCENE_COMPONENT_MAX_SLOTS;
+    SceneComponentData *pool = &scene->sceneComponentData[definitionId];
+    CloneSceneNodeComponents(scene, pool->slotNextOfNode[slot], index);
+    AddSceneComponent(scene, index, definitionId, pool->componentData + pool->slotIndices[slot] * pool->componentDataSize);
+}
+
+SceneNodeId InstantiateSceneNodeSubtree(SceneNodeId templateSceneNodeId, SceneNodeId parentSceneNodeId)
+{
+    Scene *scene;
+    unsigned int templateIndex;
+    if (!GetSceneNode(templateSceneNodeId, &scene, &templateIndex))
+    {
+        return (SceneNodeId){0};
+    }
+
+    unsigned int parentIndex = SCENE_NODE_INDEX_NONE;
+    if (parentSceneNodeId.generation != 0)
+    {
+        Scene *parentScene;
+        if (!GetSceneNode(parentSceneNodeId, &parentScene, &parentIndex) || parentScene != scene)
+        {
+            TraceLog(LOG_WARNING, "InstantiateSceneNodeSubtree: parent must be a valid node of the same scene");
+            return (SceneNodeId){0};
+        }
+    }
+
+    unsigned long count = 1;
+    for (unsigned int index = templateIndex;;)
+    {
+        if (scene->nodes[index].firstChild != SCENE_NODE_INDEX_NONE)
+        {
+            index = scene->nodes[index].firstChild;
+            count++;
+            continue;
+        }
+        while (index != templateIndex && scene->nodes[index].nextSibling == SCENE_NODE_INDEX_NONE)
+        {
+            index = scene->nodeParents[index];
+        }
+        if (index == templateIndex)
+        {
+            break;
+        }
+        index = scene->nodes[index].nextSibling;
+        count++;
+    }
+
+    // order[i] = template slot of the i-th node in depth first order, parentOrder[i] = position
+    // of its parent in the order. The ancestor stack of the walk later holds the last child
+    // cloned so far of every node
+    unsigned int *order = AllocateSceneMemory(scene, 3 * count * sizeof(unsigned int));
+    unsigned int *parentOrder = order + count;
+    unsigned int *stack = parentOrder + count;
+    unsigned long depth = 0;
+    unsigned long n = 0;
+    for (unsigned int index = templateIndex;;)
+    {
+        order[n] = index;
+        parentOrder[n] = depth > 0 ? stack[depth - 1] : SCENE_NODE_INDEX_NONE;
+        n++;
+        if (scene->nodes[index].firstChild != SCENE_NODE_INDEX_NONE)
+        {
+            stack[depth++] = (unsigned int)(n - 1);
+            index = scene->nodes[index].firstChild;
+            continue;
+        }
+        while (index != templateIndex && scene->nodes[index].nextSibling == SCENE_NODE_INDEX_NONE)
+        {
+            index = scene->nodeParents[index];
+            depth--;
+        }
+        if (index == templateIndex)
+        {
+            break;
+        }
+        index = scene->nodes[index].nextSibling;
+    }
+
+    // the clones are appended as one block, so they end up next to each other in depth first order
+    unsigned long required = scene->nodesCount + count;
+    if (required > scene->nodesCapacity)
+    {
+        unsigned long capacity = scene->nodesCapacity == 0 ? 8 : scene->nodesCapacity * 2;
+        ResizeSceneNodeArrays(scene, capacity < required ? required : capacity);
+    }
+    if (scene->nodeIdsCount + count > scene->nodeIdsCapacity)
+    {
+        unsigned long capacity = scene->nodeIdsCapacity == 0 ? 8 : scene->nodeIdsCapacity * 2;
+        ResizeSceneNodeIdArrays(scene, capacity < scene->nodeIdsCount + count ? scene->nodeIdsCount + count : capacity);
+    }
+    unsigned int base = (unsigned int)scene->nodesCount;
+    scene->nodesCount = required;
+
+    SceneId sceneId = templateSceneNodeId.sceneId;
+    for (unsigned long i = 0; i < count; i++)
+    {
+        unsigned int source = order[i];
+        unsigned int index = base + (unsigned int)i;
+        scene->nodes[index] = (SceneNode){
+            .nextSibling = SCENE_NODE_INDEX_NONE,
+            .prevSibling = SCENE_NODE_INDEX_NONE,
+            .firstChild = SCENE_NODE_INDEX_NONE,
+            .nameId = 0,
+            .firstComponent = SCENE_NODE_INDEX_NONE,
+            .userIdentifier = scene->nodes[source].userIdentifier};
+        scene->nodePositions[index] = scene->nodePositions[source];
+        scene->nodeRotations[index] = scene->nodeRotations[source];
+        scene->nodeRotationsQ[index] = scene->nodeRotationsQ[source];
+        scene->nodeRotationModes[index] = scene->nodeRotationModes[source];
+        scene->nodeTransformKinds[index] = scene->nodeTransformKinds[source];
+        scene->nodeScales[index] = scene->nodeScales[source];
+        scene->nodeLocalToWorld[index] = scene->nodeLocalToWorld[source];
+        scene->nodeModels[index] = scene->nodeModels[source];
+        scene->nodeTRSDirty[index] = 1;
+        // static subtrees are baked once the clones are in place
+        scene->nodeStatic[index] = 0;
+        scene->nodeChanged[index] = 0;
+        scene->nodeBounds[index] = SCENE_EMPTY_BOUNDS;
+        scene->nodeSubtreeBounds[index] = SCENE_EMPTY_BOUNDS;
+        scene->nodeSubtreeMeshCounts[index] = 0;
+        scene->nodeSubtreeBoundsDirty[index] = 0;
+        scene->nodeBVHLeaves[index] = SCENE_NODE_INDEX_NONE;
+        scene->nodeBVHDirty[index] = 0;
+        AssignSceneNodeId(scene, sceneId, index);
+
+        // children are appended behind the last child cloned so far, keeping the sibling order
+        if (i == 0)
+        {
+            scene->nodeParents[index] = SCENE_NODE_INDEX_NONE;
+            continue;
+        }
+        unsigned int parentClone = base + parentOrder[i];
+        scene->nodeParents[index] = parentClone;
+        unsigned int lastChild = stack[parentOrder[i]];
+        if (scene->nodes[parentClone].firstChild == SCENE_NODE_INDEX_NONE)
+        {
+            scene->nodes[parentClone].firstChild = index;
+        }
+        else
+        {
+            scene->nodes[lastChild].nextSibling = index;
+            scene->nodes[index].prevSibling = lastChild;
+        }
+        stack[parentOrder[i]] = index;
+    }
+
+    if (parentIndex != SCENE_NODE_INDEX_NONE)
+    {
+        LinkSceneNodeToParent(scene, base, parentIndex);
+    }
+
+    // names and components are shared with the template where possible: the clones refer to
+    // the same interned names and get a copy of the component data
+    for (unsigned long i = 0; i < count; i++)
+    {
+        SceneNode *source = &scene->nodes[order[i]];
+        if (source->nameId != 0)
+        {
+            SetSceneNodeNameId(scene, base + (unsigned int)i, source->nameId);
+        }
+        if (source->firstComponent != SCENE_NODE_INDEX_NONE)
+        {
+            CloneSceneNodeComponents(scene, source->firstComponent, base + (unsigned int)i);
+        }
+    }
+    for (unsigned long i = 0; i < count; i++)
+    {
+        if (scene->nodeStatic[order[i]])
+        {
+            BakeSceneNodeTree(scene, base + (unsigned int)i);
+            scene->nodeStatic[base + i] = 1;
+            scene->staticNodeCount++;
+            RemoveSceneNodeTreeBVHLeaves(scene, base + (unsigned int)i);
+            scene->isStaticBVHDirty = 1;
+        }
+    }
+
+    ReleaseSceneMemory(scene, order);
+    scene->isHierarchyOrderDirty = 1;
+    return GetSceneNodeIdOfId(scene, scene->nodeIds[base]);
+}
+
+void SetSceneNodePosition(SceneNodeId sceneNodeId, float x, float y, float z)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return;
+    }
+
+    scene->nodePositions[index] = (Vector3){x, y, z};
+    MarkSceneNodeTRSDirty(scene, index);
+}
+
+static void ClassifySceneNodeTransform(Scene *scene, unsigned int index)
+{
+    Vector3 scale = scene->nodeScales[index];
+    int hasUnitScale = scale.x == 1.0f && scale.y == 1.0f && scale.z == 1.0f;
+    unsigned char kind = SCENE_TRANSFORM_GENERAL;
+    if (scene->nodeRotationModes[index] == SCENE_ROTATION_QUATERNION)
+    {
+        Quaternion rotation = scene->nodeRotationsQ[index];
+        if (rotation.x == 0.0f && rotation.y == 0.0f && rotation.z == 0.0f && hasUnitScale)
+        {
+            kind = SCENE_TRANSFORM_TRANSLATION;
+        }
+    }
+    else
+    {
+        Vector3 rotation = scene->nodeRotations[index];
+        if (rotation.x == 0.0f && rotation.z == 0.0f)
+        {
+            kind = rotation.y == 0.0f && hasUnitScale ? SCENE_TRANSFORM_TRANSLATION : SCENE_TRANSFORM_ROTATION_Y;
+        }
+    }
+
+    scene->nodeTransformKinds[index] = kind;
+}
+
+void SetSceneNodeRotation(SceneNodeId sceneNodeId, float eulerXDeg, float eulerYDeg, float eulerZDeg)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return;
+    }
+
+    scene->nodeRotations[index] = (Vector3){eulerXDeg, eulerYDeg, eulerZDeg};
+    scene->nodeRotationModes[index] = SCENE_ROTATION_EULER;
+    ClassifySceneNodeTransform(scene, index);
+    MarkSceneNodeTRSDirty(scene, index);
+}
+
+void SetSceneNodeRotationQ(SceneNodeId sceneNodeId, Quaternion rotation)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return;
+    }
+
+    scene->nodeRotationsQ[index] = rotation;
+    scene->nodeRotationModes[index] = SCENE_ROTATION_QUATERNION;
+    ClassifySceneNodeTransform(scene, index);
+    MarkSceneNodeTRSDirty(scene, index);
+}
+
+void SetSceneNodeScale(SceneNodeId sceneNodeId, float x, float y, float z)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return;
+    }
+
+    scene->nodeScales[index] = (Vector3){x, y, z};
+    ClassifySceneNodeTransform(scene, index);
+    MarkSceneNodeTRSDirty(scene, index);
+}
+
+void SetSceneNodePositionV(SceneNodeId sceneNodeId, Vector3 position)
+{
+    SetSceneNodePosition(sceneNodeId, position.x, position.y, position.z);
+}
+
+void SetSceneNodeRotationV(SceneNodeId sceneNodeId, Vector3 rotation)
+{
+    SetSceneNodeRotation(sceneNodeId, rotation.x, rotation.y, rotation.z);
+}
+
+void SetSceneNodeScaleV(SceneNodeId sceneNodeId, Vector3 scale)
+{
+    SetSceneNodeScale(sceneNodeId, scale.x, scale.y, scale.z);
+}
+
+int SetSceneNodeTransformsBatch(const SceneNodeId *sceneNodeIds, const Vector3 *positions, const Vector3 *rotations, const Vector3 *scales, int count)
+{
+    SceneId batchSceneId = {0};
+    Scene *scene = 0;
+    int updatedCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        SceneNodeId sceneNodeId = sceneNodeIds[i];
+        unsigned int index;
+        if (!IsBatchSceneNodeValid(sceneNodeId, &batchSceneId, &scene, &index))
+        {
+            continue;
+        }
+
+        if (positions)
+        {
+            scene->nodePositions[index] = positions[i];
+        }
+        if (rotations)
+        {
+            scene->nodeRotations[index] = rotations[i];
+            scene->nodeRotationModes[index] = SCENE_ROTATION_EULER;
+        }
+        if (scales)
+        {
+            scene->nodeScales[index] = scales[i];
+        }
+        if (rotations || scales)
+        {
+            ClassifySceneNodeTransform(scene, index);
+        }
+        MarkSceneNodeTRSDirty(scene, index);
+        updatedCount++;
+    }
+
+    return updatedCount;
+}
+
+Vector3 GetSceneNodeLocalPosition(SceneNodeId sceneNodeId)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return (Vector3){0, 0, 0};
+    }
+
+    return scene->nodePositions[index];
+}
+
+// the euler conversions follow MatrixRotateXYZ, which is what euler rotations of nodes use;
+// raymath's QuaternionFromEuler uses a different convention
+static Quaternion EulerDegreesToQuaternion(Vector3 rotation)
+{
+    return QuaternionFromMatrix(MatrixRotateXYZ((Vector3){DEG2RAD * rotation.x, DEG2RAD * rotation.y, DEG2RAD * rotation.z}));
+}
+
+static Vector3 QuaternionToEulerDegrees(Quaternion rotation)
+{
+    // MatrixRotateXYZ rotates by the negated angles
+    Matrix matrix = QuaternionToMatrix(rotation);
+    float sinY = Clamp(-matrix.m8, -1.0f, 1.0f);
+    return (Vector3){-RAD2DEG * atan2f(matrix.m9, matrix.m10), -RAD2DEG * asinf(sinY), -RAD2DEG * atan2f(matrix.m4, matrix.m0)};
+}
+
+Vector3 GetSceneNodeLocalRotation(SceneNodeId sceneNodeId)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return (Vector3){0, 0, 0};
+    }
+
+    if (scene->nodeRotationModes[index] == SCENE_ROTATION_QUATERNION)
+    {
+        return QuaternionToEulerDegrees(scene->nodeRotationsQ[index]);
+    }
+
+    return scene->nodeRotations[index];
+}
+
+Quaternion GetSceneNodeLocalRotationQ(SceneNodeId sceneNodeId)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return QuaternionIdentity();
+    }
+
+    if (scene->nodeRotationModes[index] == SCENE_ROTATION_EULER)
+    {
+        return EulerDegreesToQuaternion(scene->nodeRotations[index]);
+    }
+
+    return scene->nodeRotationsQ[index];
+}
+
+Vector3 GetSceneNodeLocalScale(SceneNodeId sceneNodeId)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return (Vector3){1, 1, 1};
+    }
+
+    return scene->nodeScales[index];
+}
+
+// # Transform kernels
+// Local matrices are composed directly from position, rotation and scale. The result
+// is the same as MatrixScale * MatrixRotateXYZ (or QuaternionToMatrix) * MatrixTranslate
+// in raymath, but without the four 4x4 multiplications. With SIMD support, SCENE_SIMD_WIDTH
+// nodes are composed per iteration, including a vectorized sin/cos for euler rotations.
+
+// the scalar path; the SIMD kernels below compose the same matrices
+#if !defined(SCENE_SIMD_WIDTH)
+static SceneAffineMatrix ComposeTRSMatrix(Vector3 position, Vector3 rotation, Vector3 scale)
+{
+    // MatrixRotateXYZ rotates by the negated angles
+    float cx = cosf(-DEG2RAD * rotation.x), sx = sinf(-DEG2RAD * rotation.x);
+    float cy = cosf(-DEG2RAD * rotation.y), sy = sinf(-DEG2RAD * rotation.y);
+    float cz = cosf(-DEG2RAD * rotation.z), sz = sinf(-DEG2RAD * rotation.z);
+
+    SceneAffineMatrix result;
+    result.m0 = cz*cy*scale.x;
+    result.m1 = (cz*sy*sx - sz*cx)*scale.x;
+    result.m2 = (cz*sy*cx + sz*sx)*scale.x;
+    result.m4 = sz*cy*scale.y;
+    result.m5 = (sz*sy*sx + cz*cx)*scale.y;
+    result.m6 = (sz*sy*cx - cz*sx)*scale.y;
+    result.m8 = -sy*scale.z;
+    result.m9 = cy*sx*scale.z;
+    result.m10 = cy*cx*scale.z;
+    result.m12 = position.x;
+    result.m13 = position.y;
+    result.m14 = position.z;
+    return result;
+}
+
+static SceneAffineMatrix ComposeTRSMatrixQ(Vector3 position, Quaternion q, Vector3 scale)
+{
+    float a2 = q.x*q.x, b2 = q.y*q.y, c2 = q.z*q.z;
+    float ab = q.x*q.y, ac = q.x*q.z, bc = q.y*q.z;
+    float ad = q.w*q.x, bd = q.w*q.y, cd = q.w*q.z;
+
+    SceneAffineMatrix result;
+    result.m0 = (1.0f - 2.0f*(b2 + c2))*scale.x;
+    result.m1 = 2.0f*(ab + cd)*scale.x;
+    result.m2 = 2.0f*(ac - bd)*scale.x;
+    result.m4 = 2.0f*(ab - cd)*scale.y;
+    result.m5 = (1.0f - 2.0f*(a2 + c2))*scale.y;
+    result.m6 = 2.0f*(bc + ad)*scale.y;
+    result.m8 = 2.0f*(ac + bd)*scale.z;
+    result.m9 = 2.0f*(bc - ad)*scale.z;
+    result.m10 = (1.0f - 2.0f*(a2 + b2))*scale.z;
+    result.m12 = position.x;
+    result.m13 = position.y;
+    result.m14 = position.z;
+    return result;
+}
+
+static SceneAffineMatrix ComposeTRSMatrixY(Vector3 position, float rotationY, Vector3 scale)
+{
+    float cy = cosf(-DEG2RAD * rotationY), sy = sinf(-DEG2RAD * rotationY);
+    return (SceneAffineMatrix){
+        cy*scale.x, 0.0f, -sy*scale.z, position.x,
+        0.0f, scale.y, 0.0f, position.y,
+        sy*scale.x, 0.0f, cy*scale.z, position.z};
+}
+
+static SceneAffineMatrix ComposeSceneNodeTRSMatrix(Scene *scene, unsigned int index)
+{
+    Vector3 position = scene->nodePositions[index];
+    switch (scene->nodeTransformKinds[index])
+    {
+    case SCENE_TRANSFORM_TRANSLATION:
+        return (SceneAffineMatrix){1, 0, 0, position.x, 0, 1, 0, position.y, 0, 0, 1, position.z};
+    case SCENE_TRANSFORM_ROTATION_Y:
+        return ComposeTRSMatrixY(position, scene->nodeRotations[index].y, scene->nodeScales[index]);
+    }
+
+    if (scene->nodeRotationModes[index] == SCENE_ROTATION_QUATERNION)
+    {
+        return ComposeTRSMatrixQ(position, scene->nodeRotationsQ[index], scene->nodeScales[index]);
+    }
+
+    return ComposeTRSMatrix(position, scene->nodeRotations[index], scene->nodeScales[index]);
+}
+#endif
+
+// same as MatrixMultiply(local, parent) for affine matrices; the implicit bottom rows
+// save a quarter of the multiplications
+static SceneAffineMatrix MultiplySceneAffineMatrices(SceneAffineMatrix local, SceneAffineMatrix parent)
+{
+    const float *l = &local.m0;
+    const float *p = &parent.m0;
+    SceneAffineMatrix result;
+    float *r = &result.m0;
+#if defined(SCENE_SIMD_WIDTH)
+    // the matrix is laid out row by row (m0, m4, m8, m12, m1, ...), so every result row
+    // is a linear combination of the rows of the local matrix and its implicit (0, 0, 0, 1) row
+    __m128 l0 = _mm_loadu_ps(l), l1 = _mm_loadu_ps(l + 4), l2 = _mm_loadu_ps(l + 8);
+    __m128 l3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+    for (int i = 0; i < 12; i += 4)
+    {
+        __m128 row = _mm_mul_ps(_mm_set1_ps(p[i]), l0);
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(p[i + 1]), l1));
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(p[i + 2]), l2));
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(p[i + 3]), l3));
+        _mm_storeu_ps(r + i, row);
+    }
+#else
+    for (int i = 0; i < 12; i += 4)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            r[i + j] = p[i]*l[j] + p[i + 1]*l[4 + j] + p[i + 2]*l[8 + j];
+        }
+        r[i + 3] += p[i + 3];
+    }
+#endif
+    return result;
+}
+
+// same as MultiplySceneAffineMatrices(translation, parent): the rotation part is the parent's
+static SceneAffineMatrix TranslateSceneAffineMatrix(SceneAffineMatrix parent, Vector3 translation)
+{
+    SceneAffineMatrix result = parent;
+    result.m12 += parent.m0*translation.x + parent.m4*translation.y + parent.m8*translation.z;
+    result.m13 += parent.m1*translation.x + parent.m5*translation.y + parent.m9*translation.z;
+    result.m14 += parent.m2*translation.x + parent.m6*translation.y + parent.m10*translation.z;
+    return result;
+}
+
+// inverts the 3x3 part by cofactors and applies it to the negated translation;
+// singular matrices (e.g. a zero scale) yield the identity
+static SceneAffineMatrix InvertSceneAffineMatrix(SceneAffineMatrix m)
+{
+    float c00 = m.m5*m.m10 - m.m9*m.m6;
+    float c01 = m.m8*m.m6 - m.m4*m.m10;
+    float c02 = m.m4*m.m9 - m.m8*m.m5;
+    float det = m.m0*c00 + m.m1*c01 + m.m2*c02;
+    if (det == 0.0f)
+    {
+        return SCENE_AFFINE_IDENTITY;
+    }
+
+    float invDet = 1.0f / det;
+    SceneAffineMatrix result;
+    result.m0 = c00*invDet;
+    result.m4 = c01*invDet;
+    result.m8 = c02*invDet;
+    result.m1 = (m.m9*m.m2 - m.m1*m.m10)*invDet;
+    result.m5 = (m.m0*m.m10 - m.m8*m.m2)*invDet;
+    result.m9 = (m.m8*m.m1 - m.m0*m.m9)*invDet;
+    result.m2 = (m.m1*m.m6 - m.m5*m.m2)*invDet;
+    result.m6 = (m.m4*m.m2 - m.m0*m.m6)*invDet;
+    result.m10 = (m.m0*m.m5 - m.m4*m.m1)*invDet;
+    result.m12 = -(result.m0*m.m12 + result.m4*m.m13 + result.m8*m.m14);
+    result.m13 = -(result.m1*m.m12 + result.m5*m.m13 + result.m9*m.m14);
+    result.m14 = -(result.m2*m.m12 + result.m6*m.m13 + result.m10*m.m14);
+    return result;
+}
+
+static void TransformPointsAffine(SceneAffineMatrix m, const Vector3 *points, Vector3 *result, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        Vector3 p = points[i];
+        result[i] = (Vector3){
+            m.m0*p.x + m.m4*p.y + m.m8*p.z + m.m12,
+            m.m1*p.x + m.m5*p.y + m.m9*p.z + m.m13,
+            m.m2*p.x + m.m6*p.y + m.m10*p.z + m.m14};
+    }
+}
+
+#if defined(SCENE_SIMD_WIDTH)
+// sin and cos of angles given in degrees; accurate to a few ulp, which is plenty for transforms
+static void SinCosDegV(SceneFloatV degrees, SceneFloatV *sinOut, SceneFloatV *cosOut)
+{
+    const SceneFloatV signMask = SimdSet1(-0.0f);
+    const SceneFloatV one = SimdSet1(1.0f);
+
+    // reduce to [-180, 180] in degrees first, where the reduction is exact for large angles
+    SceneFloatV turns = SimdRound(SimdMul(degrees, SimdSet1(1.0f / 360.0f)));
+    SceneFloatV x = SimdMul(SimdSub(degrees, SimdMul(turns, SimdSet1(360.0f))), SimdSet1(DEG2RAD));
+
+    // quadrant q in [-2, 2] and r = x - q*PI/2 in [-PI/4, PI/4]
+    SceneFloatV q = SimdRound(SimdMul(x, SimdSet1(0.63661977236f)));
+    SceneFloatV r = SimdSub(x, SimdMul(q, SimdSet1(1.5703125f)));
+    r = SimdSub(r, SimdMul(q, SimdSet1(4.837512969970703125e-4f)));
+    r = SimdSub(r, SimdMul(q, SimdSet1(7.54978995489188216e-8f)));
+
+    // Cephes polynomials for sin and cos on [-PI/4, PI/4]
+    SceneFloatV z = SimdMul(r, r);
+    SceneFloatV s = SimdAdd(SimdMul(z, SimdSet1(-1.9515295891e-4f)), SimdSet1(8.3321608736e-3f));
+    s = SimdAdd(SimdMul(s, z), SimdSet1(-1.6666654611e-1f));
+    s = SimdAdd(SimdMul(SimdMul(s, z), r), r);
+    SceneFloatV c = SimdAdd(SimdMul(z, SimdSet1(2.443315711809948e-5f)), SimdSet1(-1.388731625493765e-3f));
+    c = SimdAdd(SimdMul(c, z), SimdSet1(4.166664568298827e-2f));
+    c = SimdAdd(SimdSub(SimdMul(SimdMul(c, z), z), SimdMul(z, SimdSet1(0.5f))), one);
+
+    // q mod 4 in {0, 1, 2, 3}
+    SceneFloatV quadrant = SimdAdd(q, SimdSet1(4.0f));
+    quadrant = SimdSub(quadrant, SimdAnd(SimdCmpGe(quadrant, SimdSet1(4.0f)), SimdSet1(4.0f)));
+    SceneFloatV isOdd = SimdOr(SimdCmpEq(quadrant, one), SimdCmpEq(quadrant, SimdSet1(3.0f)));
+    SceneFloatV negateSin = SimdCmpGe(quadrant, SimdSet1(2.0f));
+    SceneFloatV negateCos = SimdOr(SimdCmpEq(quadrant, one), SimdCmpEq(quadrant, SimdSet1(2.0f)));
+
+    SceneFloatV sinResult = SimdBlend(s, c, isOdd);
+    SceneFloatV cosResult = SimdBlend(c, s, isOdd);
+    *sinOut = SimdXor(sinResult, SimdAnd(negateSin, signMask));
+    *cosOut = SimdXor(cosResult, SimdAnd(negateCos, signMask));
+}
+
+// writes the 3x3 rotation-scale parts given per lane, column by column, plus the positions
+static void StoreSceneNodeLocalMatricesV(Scene *scene, const unsigned int *indices, float m[9][SCENE_SIMD_WIDTH])
+{
+    for (int j = 0; j < SCENE_SIMD_WIDTH; j++)
+    {
+        Vector3 position = scene->nodePositions[indices[j]];
+        scene->nodeLocalToWorld[indices[j]] = (SceneAffineMatrix){
+            m[0][j], m[3][j], m[6][j], position.x,
+            m[1][j], m[4][j], m[7][j], position.y,
+            m[2][j], m[5][j], m[8][j], position.z};
+    }
+}
+
+// composes the local matrices of SCENE_SIMD_WIDTH nodes with euler rotations
+static void ComposeSceneNodeTRSMatricesV(Scene *scene, const unsigned int *indices)
+{
+    float lanes[6][SCENE_SIMD_WIDTH];
+    for (int j = 0; j < SCENE_SIMD_WIDTH; j++)
+    {
+        Vector3 rotation = scene->nodeRotations[indices[j]];
+        Vector3 scale = scene->nodeScales[indices[j]];
+        lanes[0][j] = -rotation.x;
+        lanes[1][j] = -rotation.y;
+        lanes[2][j] = -rotation.z;
+        lanes[3][j] = scale.x;
+        lanes[4][j] = scale.y;
+        lanes[5][j] = scale.z;
+    }
+
+    SceneFloatV sx, cx, sy, cy, sz, cz;
+    SinCosDegV(SimdLoad(lanes[0]), &sx, &cx);
+    SinCosDegV(SimdLoad(lanes[1]), &sy, &cy);
+    SinCosDegV(SimdLoad(lanes[2]), &sz, &cz);
+    SceneFloatV scaleX = SimdLoad(lanes[3]);
+    SceneFloatV scaleY = SimdLoad(lanes[4]);
+    SceneFloatV scaleZ = SimdLoad(lanes[5]);
+
+    SceneFloatV czsy = SimdMul(cz, sy);
+    SceneFloatV szsy = SimdMul(sz, sy);
+    float m[9][SCENE_SIMD_WIDTH];
+    SimdStore(m[0], SimdMul(SimdMul(cz, cy), scaleX));
+    SimdStore(m[1], SimdMul(SimdSub(SimdMul(czsy, sx), SimdMul(sz, cx)), scaleX));
+    SimdStore(m[2], SimdMul(SimdAdd(SimdMul(czsy, cx), SimdMul(sz, sx)), scaleX));
+    SimdStore(m[3], SimdMul(SimdMul(sz, cy), scaleY));
+    SimdStore(m[4], SimdMul(SimdAdd(SimdMul(szsy, sx), SimdMul(cz, cx)), scaleY));
+    SimdStore(m[5], SimdMul(SimdSub(SimdMul(szsy, cx), SimdMul(cz, sx)), scaleY));
+    SimdStore(m[6], SimdMul(SimdXor(sy, SimdSet1(-0.0f)), scaleZ));
+    SimdStore(m[7], SimdMul(SimdMul(cy, sx), scaleZ));
+    SimdStore(m[8], SimdMul(SimdMul(cy, cx), scaleZ));
+
+    StoreSceneNodeLocalMatricesV(scene, indices, m);
+}
+
+// composes the local matrices of SCENE_SIMD_WIDTH nodes rotating around the y axis only
+static void ComposeSceneNodeTRSMatricesYV(Scene *scene, const unsigned int *indices)
+{
+    float lanes[4][SCENE_SIMD_WIDTH];
+    for (int j = 0; j < SCENE_SIMD_WIDTH; j++)
+    {
+        Vector3 scale = scene->nodeScales[indices[j]];
+        lanes[0][j] = -scene->nodeRotations[indices[j]].y;
+        lanes[1][j] = scale.x;
+        lanes[2][j] = scale.y;
+        lanes[3][j] = scale.z;
+    }
+
+    SceneFloatV sy, cy;
+    SinCosDegV(SimdLoad(lanes[0]), &sy, &cy);
+    SceneFloatV scaleX = SimdLoad(lanes[1]);
+    SceneFloatV scaleZ = SimdLoad(lanes[3]);
+    SceneFloatV zero = SimdSet1(0.0f);
+
+    float m[9][SCENE_SIMD_WIDTH];
+    SimdStore(m[0], SimdMul(cy, scaleX));
+    SimdStore(m[1], zero);
+    SimdStore(m[2], SimdMul(sy, scaleX));
+    SimdStore(m[3], zero);
+    SimdStore(m[4], SimdLoad(lanes[2]));
+    SimdStore(m[5], zero);
+    SimdStore(m[6], SimdMul(SimdXor(sy, SimdSet1(-0.0f)), scaleZ));
+    SimdStore(m[7], zero);
+    SimdStore(m[8], SimdMul(cy, scaleZ));
+
+    StoreSceneNodeLocalMatricesV(scene, indices, m);
+}
+
+// composes the local matrices of SCENE_SIMD_WIDTH nodes with quaternion rotations
+static void ComposeSceneNodeTRSMatricesQV(Scene *scene, const unsigned int *indices)
+{
+    float lanes[7][SCENE_SIMD_WIDTH];
+    for (int j = 0; j < SCENE_SIMD_WIDTH; j++)
+    {
+        Quaternion rotation = scene->nodeRotationsQ[indices[j]];
+        Vector3 scale = scene->nodeScales[indices[j]];
+        lanes[0][j] = rotation.x;
+        lanes[1][j] = rotation.y;
+        lanes[2][j] = rotation.z;
+        lanes[3][j] = rotation.w;
+        lanes[4][j] = scale.x;
+        lanes[5][j] = scale.y;
+        lanes[6][j] = scale.z;
+    }
+
+    SceneFloatV qx = SimdLoad(lanes[0]), qy = SimdLoad(lanes[1]), qz = SimdLoad(lanes[2]), qw = SimdLoad(lanes[3]);
+    SceneFloatV scaleX = SimdLoad(lanes[4]);
+    SceneFloatV scaleY = SimdLoad(lanes[5]);
+    SceneFloatV scaleZ = SimdLoad(lanes[6]);
+    SceneFloatV one = SimdSet1(1.0f), two = SimdSet1(2.0f);
+
+    SceneFloatV a2 = SimdMul(qx, qx), b2 = SimdMul(qy, qy), c2 = SimdMul(qz, qz);
+    SceneFloatV ab = SimdMul(qx, qy), ac = SimdMul(qx, qz), bc = SimdMul(qy, qz);
+    SceneFloatV ad = SimdMul(qw, qx), bd = SimdMul(qw, qy), cd = SimdMul(qw, qz);
+    float m[9][SCENE_SIMD_WIDTH];
+    SimdStore(m[0], SimdMul(SimdSub(one, SimdMul(two, SimdAdd(b2, c2))), scaleX));
+    SimdStore(m[1], SimdMul(SimdMul(two, SimdAdd(ab, cd)), scaleX));
+    SimdStore(m[2], SimdMul(SimdMul(two, SimdSub(ac, bd)), scaleX));
+    SimdStore(m[3], SimdMul(SimdMul(two, SimdSub(ab, cd)), scaleY));
+    SimdStore(m[4], SimdMul(SimdSub(one, SimdMul(two, SimdAdd(a2, c2))), scaleY));
+    SimdStore(m[5], SimdMul(SimdMul(two, SimdAdd(bc, ad)), scaleY));
+    SimdStore(m[6], SimdMul(SimdMul(two, SimdAdd(ac, bd)), scaleZ));
+    SimdStore(m[7], SimdMul(SimdMul(two, SimdSub(bc, ad)), scaleZ));
+    SimdStore(m[8], SimdMul(SimdSub(one, SimdMul(two, SimdAdd(a2, b2))), scaleZ));
+
+    StoreSceneNodeLocalMatricesV(scene, indices, m);
+}
+#endif
+
+// composes the local matrices of the given nodes and stores them in nodeLocalToWorld;
+// translation-only nodes are skipped, MultiplySceneNodeParentMatrices handles them entirely
+static void ComposeSceneNodeTRSMatrices(Scene *scene, const unsigned int *indices, unsigned long count)
+{
+#if defined(SCENE_SIMD_WIDTH)
+    // general euler, y rotation and quaternion nodes are collected into separate batches
+    static void (*const kernels[3])(Scene *scene, const unsigned int *indices) = {
+        ComposeSceneNodeTRSMatricesV, ComposeSceneNodeTRSMatricesYV, ComposeSceneNodeTRSMatricesQV};
+    unsigned int batches[3][SCENE_SIMD_WIDTH];
+    int batchCounts[3] = {0};
+    for (unsigned long i = 0; i < count; i++)
+    {
+        unsigned int index = indices[i];
+        unsigned char kind = scene->nodeTransformKinds[index];
+        if (kind == SCENE_TRANSFORM_TRANSLATION)
+        {
+            continue;
+        }
+
+        int batch = kind == SCENE_TRANSFORM_ROTATION_Y ? 1 : scene->nodeRotationModes[index] == SCENE_ROTATION_QUATERNION ? 2 : 0;
+        batches[batch][batchCounts[batch]++] = index;
+        if (batchCounts[batch] == SCENE_SIMD_WIDTH)
+        {
+            kernels[batch](scene, batches[batch]);
+            batchCounts[batch] = 0;
+        }
+    }
+
+    // partial batches are padded by repeating their last node, so every node goes through the
+    // same kernel and gets the same result no matter how the list is split up
+    for (int batch = 0; batch < 3; batch++)
+    {
+        int batchCount = batchCounts[batch];
+        if (batchCount > 0)
+        {
+            for (int j = batchCount; j < SCENE_SIMD_WIDTH; j++)
+            {
+                batches[batch][j] = batches[batch][batchCount - 1];
+            }
+            kernels[batch](scene, batches[batch]);
+        }
+    }
+#else
+    for (unsigned long i = 0; i < count; i++)
+    {
+        unsigned int index = indices[i];
+        if (scene->nodeTransformKinds[index] != SCENE_TRANSFORM_TRANSLATION)
+        {
+            scene->nodeLocalToWorld[index] = ComposeSceneNodeTRSMatrix(scene, index);
+        }
+    }
+#endif
+}
+
+// multiplies the composed local matrices of the given nodes with their parent's localToWorld;
+// the parents must be up to date already
+static void MultiplySceneNodeParentMatrices(Scene *scene, const unsigned int *indices, unsigned long count)
+{
+    for (unsigned long i = 0; i < count; i++)
+    {
+        unsigned int index = indices[i];
+        unsigned int parentIndex = scene->nodeParents[index];
+        if (scene->nodeTransformKinds[index] == SCENE_TRANSFORM_TRANSLATION)
+        {
+            SceneAffineMatrix parent = parentIndex != SCENE_NODE_INDEX_NONE ? scene->nodeLocalToWorld[parentIndex] : SCENE_AFFINE_IDENTITY;
+            scene->nodeLocalToWorld[index] = TranslateSceneAffineMatrix(parent, scene->nodePositions[index]);
+        }
+        else if (parentIndex != SCENE_NODE_INDEX_NONE)
+        {
+            scene->nodeLocalToWorld[index] = MultiplySceneAffineMatrices(scene->nodeLocalToWorld[index], scene->nodeLocalToWorld[parentIndex]);
+        }
+        scene->nodeTRSDirty[index] = 0;
+
+        // while the matrix is at hand
+        if (scene->nodeModels[index] >= 0)
+        {
+            scene->nodeBounds[index] = TransformSceneNodeBounds(scene, index);
+        }
+    }
+}
+
+// # Worker pool
+// A job processes a range of items, which is handed out to the workers and the calling
+// thread in chunks. Every item is processed by the same code no matter which thread gets
+// it, so the results are identical to a serial update.
+
+// processes the items [start, start + count) of the job
+typedef void (*SceneJob)(void *data, unsigned long start, unsigned long count);
+// runs a node function over a list of node indices
+typedef void (*SceneNodeJob)(Scene *scene, const unsigned int *indices, unsigned long count);
+
+#if defined(SCENE_THREADS)
+#define SCENE_MAX_WORKER_COUNT 8
+#define SCENE_WORKER_CHUNK_SIZE 1024
+
+typedef struct SceneWorkerPool
+{
+    pthread_t threads[SCENE_MAX_WORKER_COUNT];
+    int threadCount;
+    char isRunning;
+    char isStopping;
+    pthread_mutex_t mutex;
+    pthread_cond_t jobStarted;
+    pthread_cond_t jobFinished;
+
+    // the current job; all fields are guarded by the mutex
+    SceneJob job;
+    void *data;
+    unsigned long count;
+    unsigned long nextIndex;
+    unsigned long finishedCount;
+    unsigned long jobCounter;
+} SceneWorkerPool;
+
+static SceneWorkerPool workerPool = {0};
+
+// processes chunks of the current job until none are left; called with the mutex locked
+static void RunSceneWorkerChunks(SceneWorkerPool *pool)
+{
+    while (pool->nextIndex < pool->count)
+    {
+        unsigned long start = pool->nextIndex;
+        unsigned long count = pool->count - start;
+        if (count > SCENE_WORKER_CHUNK_SIZE)
+        {
+            count = SCENE_WORKER_CHUNK_SIZE;
+        }
+        pool->nextIndex += count;
+
+        SceneJob job = pool->job;
+        void *data = pool->data;
+        pthread_mutex_unlock(&pool->mutex);
+        job(data, start, count);
+        pthread_mutex_lock(&pool->mutex);
+
+        pool->finishedCount += count;
+        if (pool->finishedCount == pool->count)
+        {
+            pthread_cond_signal(&pool->jobFinished);
+        }
+    }
+}
+
+static void *SceneWorkerMain(void *data)
+{
+    SceneWorkerPool *pool = data;
+    unsigned long seenJobCounter = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (1)
+    {
+        while (!pool->isStopping && pool->jobCounter == seenJobCounter)
+        {
+            pthread_cond_wait(&pool->jobStarted, &pool->mutex);
+        }
+        if (pool->isStopping)
+        {
+            break;
+        }
+
+        seenJobCounter = pool->jobCounter;
+        RunSceneWorkerChunks(pool);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return 0;
+}
+
+// starts the workers on first use; returns 0 if there are no other cores to share the work with
+static int StartSceneWorkerPool(void)
+{
+    SceneWorkerPool *pool = &workerPool;
+    if (pool->isRunning)
+    {
+        return pool->threadCount > 0;
+    }
+
+#if defined(SCENE_WORKER_COUNT)
+    long coreCount = SCENE_WORKER_COUNT;
+#elif defined(_WIN32)
+    long coreCount = pthread_num_processors_np();
+#else
+    long coreCount = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (coreCount > SCENE_MAX_WORKER_COUNT)
+    {
+        coreCount = SCENE_MAX_WORKER_COUNT;
+    }
+
+    pthread_mutex_init(&pool->mutex, 0);
+    pthread_cond_init(&pool->jobStarted, 0);
+    pthread_cond_init(&pool->jobFinished, 0);
+    pool->isRunning = 1;
+
+    // the calling thread works on the jobs as well
+    for (long i = 0; i < coreCount - 1; i++)
+    {
+        if (pthread_create(&pool->threads[pool->threadCount], 0, SceneWorkerMain, pool) != 0)
+        {
+            TraceLog(LOG_WARNING, "StartSceneWorkerPool: failed to create worker thread %ld", i);
+            break;
+        }
+        pool->threadCount++;
+    }
+
+    return pool->threadCount > 0;
+}
+
+static void StopSceneWorkerPool(void)
+{
+    SceneWorkerPool *pool = &workerPool;
+    if (!pool->isRunning)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->isStopping = 1;
+    pthread_cond_broadcast(&pool->jobStarted);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->threadCount; i++)
+    {
+        pthread_join(pool->threads[i], 0);
+    }
+
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->jobStarted);
+    pthread_cond_destroy(&pool->jobFinished);
+    *pool = (SceneWorkerPool){0};
+}
+
+// runs the job on the worker pool and returns when all items are processed;
+// small jobs are run directly since waking the workers would cost more than it saves
+static void RunSceneJob(SceneJob job, void *data, unsigned long count)
+{
+    if (count < 2 * SCENE_WORKER_CHUNK_SIZE || !StartSceneWorkerPool())
+    {
+        job(data, 0, count);
+        return;
+    }
+
+    SceneWorkerPool *pool = &workerPool;
+    pthread_mutex_lock(&pool->mutex);
+    pool->job = job;
+    pool->data = data;
+    pool->count = count;
+    pool->nextIndex = 0;
+    pool->finishedCount = 0;
+    pool->jobCounter++;
+    pthread_cond_broadcast(&pool->jobStarted);
+
+    RunSceneWorkerChunks(pool);
+    while (pool->finishedCount < pool->count)
+    {
+        pthread_cond_wait(&pool->jobFinished, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+#else
+static void StopSceneWorkerPool(void)
+{
+}
+
+static void RunSceneJob(SceneJob job, void *data, unsigned long count)
+{
+    job(data, 0, count);
+}
+#endif
+
+typedef struct SceneNodeJobData
+{
+    SceneNodeJob job;
+    Scene *scene;
+    const unsigned int *indices;
+} SceneNodeJobData;
+
+static void RunSceneNodeJobChunk(void *data, unsigned long start, unsigned long count)
+{
+    SceneNodeJobData *nodeJob = data;
+    nodeJob->job(nodeJob->scene, &nodeJob->indices[start], count);
+}
+
+static void RunSceneNodeJob(SceneNodeJob job, Scene *scene, const unsigned int *indices, unsigned long count)
+{
+    SceneNodeJobData data = {job, scene, indices};
+    RunSceneJob(RunSceneNodeJobChunk, &data, count);
+}
+
+// appends the node to changedNodes unless it's already listed
+static void RecordSceneNodeChange(Scene *scene, unsigned int index)
+{
+    if (scene->nodeChanged[index])
+    {
+        return;
+    }
+
+    if (scene->changedNodesCount >= scene->changedNodesCapacity)
+    {
+        unsigned long capacity = scene->changedNodesCapacity == 0 ? 64 : scene->changedNodesCapacity * 2;
+        scene->changedNodes = ResizeSceneArray(scene, scene->changedNodes, scene->changedNodesCapacity * sizeof(SceneNodeHandle), capacity * sizeof(SceneNodeHandle));
+        scene->changedNodesCapacity = capacity;
+    }
+
+    scene->nodeChanged[index] = 1;
+    unsigned int id = scene->nodeIds[index];
+    scene->changedNodes[scene->changedNodesCount++] = ((SceneNodeHandle)scene->nodeHandleTags[id] << 32) | (SceneNodeHandle)id;
+}
+
+static void RebuildSceneHierarchyOrder(Scene *scene)
+{
+    if (scene->hierarchyOrderCapacity < scene->nodesCount)
+    {
+        unsigned long oldCapacity = scene->hierarchyOrderCapacity;
+        unsigned long capacity = scene->nodesCapacity;
+        scene->hierarchyOrder = ResizeSceneArray(scene, scene->hierarchyOrder, oldCapacity * sizeof(SceneHierarchyEntry), capacity * sizeof(SceneHierarchyEntry));
+        scene->hierarchyLevelEnds = ResizeSceneArray(scene, scene->hierarchyLevelEnds, oldCapacity * sizeof(unsigned long), capacity * sizeof(unsigned long));
+        scene->dirtyNodes = ResizeSceneArray(scene, scene->dirtyNodes, oldCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+        scene->dirtyLevelEnds = ResizeSceneArray(scene, scene->dirtyLevelEnds, oldCapacity * sizeof(unsigned long), capacity * sizeof(unsigned long));
+        scene->rootNodes = ResizeSceneArray(scene, scene->rootNodes, oldCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+        scene->hierarchyOrderCapacity = capacity;
+    }
+
+    // roots first, then the order list itself serves as the queue for a breadth first walk,
+    // so every parent is listed before its children. Static subtrees are left out, so their
+    // nodes cost nothing in transform updates
+    unsigned long count = 0;
+    unsigned long rootCount = 0;
+    for (unsigned int i = 0; i < scene->nodesCount; i++)
+    {
+        if (scene->nodeIds[i] == SCENE_NODE_INDEX_NONE || scene->nodeParents[i] != SCENE_NODE_INDEX_NONE)
+        {
+            continue;
+        }
+
+        scene->rootNodes[rootCount++] = i;
+        if (!scene->nodeStatic[i])
+        {
+            scene->hierarchyOrder[count++] = (SceneHierarchyEntry){i, SCENE_NODE_INDEX_NONE};
+        }
+    }
+    scene->rootNodesCount = rootCount;
+
+    // when the walk reaches the end of a level, all nodes of the next level have been queued
+    unsigned long levelCount = 0;
+    unsigned long levelEnd = count;
+    for (unsigned long i = 0; i < count; i++)
+    {
+        if (i == levelEnd)
+        {
+            scene->hierarchyLevelEnds[levelCount++] = levelEnd;
+            levelEnd = count;
+        }
+
+        unsigned int parentIndex = scene->hierarchyOrder[i].nodeIndex;
+        for (unsigned int child = scene->nodes[parentIndex].firstChild; child != SCENE_NODE_INDEX_NONE; child = scene->nodes[child].nextSibling)
+        {
+            if (!scene->nodeStatic[child])
+            {
+                scene->hierarchyOrder[count++] = (SceneHierarchyEntry){child, parentIndex};
+            }
+        }
+    }
+    if (count > 0)
+    {
+        scene->hierarchyLevelEnds[levelCount++] = count;
+    }
+
+    scene->hierarchyOrderCount = count;
+    scene->hierarchyLevelCount = levelCount;
+    scene->isHierarchyOrderDirty = 0;
+}
+
+// recomputes the node's subtree bounds from its own and its children's
+static void RefitSceneNodeBounds(Scene *scene, unsigned int index)
+{
+    int modelIndex = scene->nodeModels[index];
+    BoundingBox bounds = scene->nodeBounds[index];
+    unsigned int meshCount = modelIndex >= 0 ? scene->models[modelIndex].model.meshCount : 0;
+    for (unsigned int child = scene->nodes[index].firstChild; child != SCENE_NODE_INDEX_NONE; child = scene->nodes[child].nextSibling)
+    {
+        bounds = UnionSceneBounds(bounds, scene->nodeSubtreeBounds[child]);
+        meshCount += scene->nodeSubtreeMeshCounts[child];
+    }
+    scene->nodeSubtreeBounds[index] = bounds;
+    scene->nodeSubtreeMeshCounts[index] = meshCount;
+    scene->nodeSubtreeBoundsDirty[index] = 0;
+}
+
+// returns the first marked node among the node and its next siblings
+static unsigned int FindSceneSubtreeBoundsDirty(Scene *scene, unsigned int index)
+{
+    while (index != SCENE_NODE_INDEX_NONE && !scene->nodeSubtreeBoundsDirty[index])
+    {
+        index = scene->nodes[index].nextSibling;
+    }
+
+    return index;
+}
+
+// refits the marked nodes of every listed tree in one post-order walk along the tree links
+static void UpdateSceneBounds(Scene *scene)
+{
+    for (unsigned long i = 0; i < scene->boundsDirtyRootsCount; i++)
+    {
+        // roots may have been released or attached to another tree, which is then listed itself
+        unsigned int id = scene->boundsDirtyRoots[i];
+        if (scene->nodeIdGenerations[id] <= 0)
+        {
+            continue;
+        }
+        unsigned int root = scene->nodeIdIndices[id];
+        if (!scene->nodeSubtreeBoundsDirty[root] || scene->nodeParents[root] != SCENE_NODE_INDEX_NONE)
+        {
+            continue;
+        }
+
+        unsigned int index = root;
+        while (1)
+        {
+            unsigned int child = FindSceneSubtreeBoundsDirty(scene, scene->nodes[index].firstChild);
+            if (child != SCENE_NODE_INDEX_NONE)
+            {
+                index = child;
+                continue;
+            }
+
+            // all marked children are refit at this point
+            RefitSceneNodeBounds(scene, index);
+            if (index == root)
+            {
+                break;
+            }
+            unsigned int sibling = FindSceneSubtreeBoundsDirty(scene, scene->nodes[index].nextSibling);
+            index = sibling != SCENE_NODE_INDEX_NONE ? sibling : scene->nodeParents[index];
+        }
+    }
+    scene->boundsDirtyRootsCount = 0;
+}
+
+void UpdateSceneTransforms(SceneId sceneId)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene)
+    {
+        return;
+    }
+
+    if (scene->isHierarchyOrderDirty)
+    {
+        RebuildSceneHierarchyOrder(scene);
+    }
+
+    // collect the dirty nodes in hierarchy order, remembering where each level ends
+    unsigned int *dirtyNodes = scene->dirtyNodes;
+    unsigned long dirtyCount = 0;
+    unsigned long dirtyLevelCount = 0;
+    unsigned long levelStart = 0;
+    for (unsigned long level = 0; level < scene->hierarchyLevelCount; level++)
+    {
+        unsigned long levelEnd = scene->hierarchyLevelEnds[level];
+        unsigned long levelDirtyStart = dirtyCount;
+        for (unsigned long i = levelStart; i < levelEnd; i++)
+        {
+            unsigned int index = scene->hierarchyOrder[i].nodeIndex;
+            if (scene->nodeTRSDirty[index])
+            {
+                dirtyNodes[dirtyCount++] = index;
+            }
+        }
+        if (dirtyCount > levelDirtyStart)
+        {
+            scene->dirtyLevelEnds[dirtyLevelCount++] = dirtyCount;
+        }
+        levelStart = levelEnd;
+    }
+
+    if (!(scene->flags & SCENE_FLAG_PARALLEL_TRANSFORMS))
+    {
+        // parents come first, so a parent's localToWorld is always final when its children are multiplied
+        ComposeSceneNodeTRSMatrices(scene, dirtyNodes, dirtyCount);
+        MultiplySceneNodeParentMatrices(scene, dirtyNodes, dirtyCount);
+    }
+    else
+    {
+        // local matrices are independent of each other, but each level needs the previous one
+        // to be finished before it can be multiplied with its parents
+        RunSceneNodeJob(ComposeSceneNodeTRSMatrices, scene, dirtyNodes, dirtyCount);
+        unsigned long dirtyLevelStart = 0;
+        for (unsigned long level = 0; level < dirtyLevelCount; level++)
+        {
+            unsigned long dirtyLevelEnd = scene->dirtyLevelEnds[level];
+            RunSceneNodeJob(MultiplySceneNodeParentMatrices, scene, &dirtyNodes[dirtyLevelStart], dirtyLevelEnd - dirtyLevelStart);
+            dirtyLevelStart = dirtyLevelEnd;
+        }
+    }
+
+    if (scene->flags & SCENE_FLAG_RECORD_CHANGES)
+    {
+        for (unsigned long i = 0; i < dirtyCount; i++)
+        {
+            RecordSceneNodeChange(scene, dirtyNodes[i]);
+        }
+    }
+
+    for (unsigned long i = 0; i < dirtyCount; i++)
+    {
+        if (scene->nodeModels[dirtyNodes[i]] >= 0)
+        {
+            MarkSceneSubtreeBoundsDirty(scene, dirtyNodes[i]);
+            MarkSceneNodeBVHDirty(scene, dirtyNodes[i]);
+        }
+    }
+    UpdateSceneBounds(scene);
+}
+
+// updates the localToWorld of the listed nodes, parents first, through the same kernels as
+// UpdateSceneTransforms, so both give bit-identical results
+static void UpdateSceneNodeList(Scene *scene, const unsigned int *indices, unsigned long count)
+{
+    ComposeSceneNodeTRSMatrices(scene, indices, count);
+    MultiplySceneNodeParentMatrices(scene, indices, count);
+    for (unsigned long i = 0; i < count; i++)
+    {
+        if (scene->nodeModels[indices[i]] >= 0)
+        {
+            MarkSceneSubtreeBoundsDirty(scene, indices[i]);
+            MarkSceneNodeBVHDirty(scene, indices[i]);
+        }
+        if (scene->flags & SCENE_FLAG_RECORD_CHANGES)
+        {
+            RecordSceneNodeChange(scene, indices[i]);
+        }
+    }
+}
+
+// brings the node's localToWorld up to date along with its dirty ancestors
+static void UpdateSceneNodeTRS(Scene *scene, unsigned int index)
+{
+    if (!scene->nodeTRSDirty[index])
+    {
+        return;
+    }
+
+    // changes inside a static subtree are applied when it's no longer static
+    if (scene->staticNodeCount > 0 && IsSceneNodeInStaticTree(scene, index))
+    {
+        return;
+    }
+
+    // dirty marks are pushed down to the children, so outside static trees the dirty
+    // ancestors of a dirty node end at the first clean one
+    unsigned long chainCount = 0;
+    for (unsigned int ancestor = index; ancestor != SCENE_NODE_INDEX_NONE && scene->nodeTRSDirty[ancestor]; ancestor = scene->nodeParents[ancestor])
+    {
+        chainCount++;
+    }
+    if (scene->dirtyChainCapacity < chainCount)
+    {
+        unsigned long capacity = scene->dirtyChainCapacity == 0 ? 64 : scene->dirtyChainCapacity;
+        while (capacity < chainCount)
+        {
+            capacity *= 2;
+        }
+        scene->dirtyChain = ResizeSceneArray(scene, scene->dirtyChain, scene->dirtyChainCapacity * sizeof(unsigned int), capacity * sizeof(unsigned int));
+        scene->dirtyChainCapacity = capacity;
+    }
+
+    // filled from the back, so parents come first like in UpdateSceneTransforms
+    unsigned int *chain = scene->dirtyChain;
+    unsigned long i = chainCount;
+    for (unsigned int ancestor = index; i > 0; ancestor = scene->nodeParents[ancestor])
+    {
+        chain[--i] = ancestor;
+    }
+
+    UpdateSceneNodeList(scene, chain, chainCount);
+}
+
+const SceneNodeHandle *GetSceneChangedNodes(SceneId sceneId, unsigned long *count)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene)
+    {
+        *count = 0;
+        return 0;
+    }
+
+    *count = scene->changedNodesCount;
+    return scene->changedNodes;
+}
+
+void ClearSceneChangedNodes(SceneId sceneId)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene)
+    {
+        return;
+    }
+
+    // the flags of released nodes are reset when their slot is reused
+    for (unsigned long i = 0; i < scene->changedNodesCount; i++)
+    {
+        unsigned int index;
+        if (GetSceneOfNodeHandle(scene->changedNodes[i], &index))
+        {
+            scene->nodeChanged[index] = 0;
+        }
+    }
+    scene->changedNodesCount = 0;
+}
+
+// brings the node's localToWorld up to date; returns 0 for invalid nodes
+static int GetSceneNodeLocalToWorld(SceneNodeId sceneNodeId, SceneAffineMatrix *localToWorld)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return 0;
+    }
+
+    UpdateSceneNodeTRS(scene, index);
+    *localToWorld = scene->nodeLocalToWorld[index];
+    return 1;
+}
+
+// brings the world transforms of the subtree up to date, not descending into static subtrees
+static void BakeSceneNodeTree(Scene *scene, unsigned int root)
+{
+    UpdateSceneNodeTRS(scene, root);
+    if (scene->nodeTRSDirty[root])
+    {
+        // the root is inside a static tree
+        return;
+    }
+
+    // pre-order, so the parent of every dirty node is up to date when it is reached
+    unsigned int index = root;
+    unsigned int child = scene->nodes[root].firstChild;
+    while (1)
+    {
+        while (child != SCENE_NODE_INDEX_NONE && scene->nodeStatic[child])
+        {
+            child = scene->nodes[child].nextSibling;
+        }
+        if (child != SCENE_NODE_INDEX_NONE)
+        {
+            if (scene->nodeTRSDirty[child])
+            {
+                UpdateSceneNodeList(scene, &child, 1);
+            }
+            index = child;
+            child = scene->nodes[index].firstChild;
+            continue;
+        }
+
+        if (index == root)
+        {
+            break;
+        }
+        child = scene->nodes[index].nextSibling;
+        index = scene->nodeParents[index];
+    }
+}
+
+void SetSceneNodeStatic(SceneNodeId sceneNodeId, int isStatic)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return;
+    }
+
+    if (scene->nodeStatic[index] == (isStatic != 0))
+    {
+        return;
+    }
+
+    if (isStatic)
+    {
+        BakeSceneNodeTree(scene, index);
+        scene->nodeStatic[index] = 1;
+        scene->staticNodeCount++;
+        RemoveSceneNodeTreeBVHLeaves(scene, index);
+    }
+    else
+    {
+        // the parent or the node itself may have moved while the subtree was static
+        scene->nodeStatic[index] = 0;
+        scene->staticNodeCount--;
+        scene->nodeTRSDirty[index] = 0;
+        MarkSceneNodeTRSDirty(scene, index);
+    }
+    scene->isHierarchyOrderDirty = 1;
+    scene->isStaticBVHDirty = 1;
+}
+
+int IsSceneNodeStatic(SceneNodeId sceneNodeId)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return 0;
+    }
+
+    return IsSceneNodeInStaticTree(scene, index);
+}
+
+Matrix GetSceneNodeLocalTransform(SceneNodeId sceneNodeId)
+{
+    SceneAffineMatrix localToWorld;
+    if (!GetSceneNodeLocalToWorld(sceneNodeId, &localToWorld))
+    {
+        return MatrixIdentity();
+    }
+
+    return AffineToMatrix(localToWorld);
+}
+
+// the inverse isn't stored per node but computed on request
+Matrix GetSceneNodeWorldToLocalTransform(SceneNodeId sceneNodeId)
+{
+    SceneAffineMatrix localToWorld;
+    if (!GetSceneNodeLocalToWorld(sceneNodeId, &localToWorld))
+    {
+        return MatrixIdentity();
+    }
+
+    return AffineToMatrix(InvertSceneAffineMatrix(localToWorld));
+}
+
+int GetSceneNodeWorldMatricesBatch(const SceneNodeId *sceneNodeIds, Matrix *matrices, int count)
+{
+    SceneId batchSceneId = {0};
+    Scene *scene = 0;
+    int validCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        SceneNodeId sceneNodeId = sceneNodeIds[i];
+        unsigned int index;
+        if (!IsBatchSceneNodeValid(sceneNodeId, &batchSceneId, &scene, &index))
+        {
+            matrices[i] = MatrixIdentity();
+            continue;
+        }
+
+        UpdateSceneNodeTRS(scene, index);
+        matrices[i] = AffineToMatrix(scene->nodeLocalToWorld[index]);
+        validCount++;
+    }
+
+    return validCount;
+}
+
+void TransformSceneNodePointsToWorld(SceneNodeId sceneNodeId, const Vector3 *points, Vector3 *result, int count)
+{
+    SceneAffineMatrix localToWorld;
+    if (count <= 0)
+    {
+        return;
+    }
+    if (!GetSceneNodeLocalToWorld(sceneNodeId, &localToWorld))
+    {
+        memmove(result, points, sizeof(Vector3) * count);
+        return;
+    }
+
+    TransformPointsAffine(localToWorld, points, result, count);
+}
+
+void TransformSceneNodePointsToLocal(SceneNodeId sceneNodeId, const Vector3 *points, Vector3 *result, int count)
+{
+    SceneAffineMatrix localToWorld;
+    if (count <= 0)
+    {
+        return;
+    }
+    if (!GetSceneNodeLocalToWorld(sceneNodeId, &localToWorld))
+    {
+        memmove(result, points, sizeof(Vector3) * count);
+        return;
+    }
+
+    TransformPointsAffine(InvertSceneAffineMatrix(localToWorld), points, result, count);
+}
+
+Vector3 GetSceneNodeWorldPosition(SceneNodeId sceneNodeId)
+{
+    Matrix localToWorld = GetSceneNodeLocalTransform(sceneNodeId);
+    return (Vector3){localToWorld.m12, localToWorld.m13, localToWorld.m14};
+}
 
 Vector3 GetSceneNodeWorldForward(SceneNodeId sceneNodeId)
 {
@@ -771,50 +5023,125 @@ Vector3 GetSceneNodeWorldRight(SceneNodeId sceneNodeId)
     return (Vector3){localToWorld.m0, localToWorld.m1, localToWorld.m2};
 }
 
-static char *StringDup(const char *str)
+BoundingBox GetSceneNodeWorldBounds(SceneNodeId sceneNodeId)
 {
-    if (!str)
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
     {
-        return 0;
+        return SCENE_EMPTY_BOUNDS;
     }
 
-    unsigned long len = strlen(str);
-    char *dup = MemAlloc(len + 1);
-    strcpy(dup, str);
-    return dup;
+    return scene->nodeBounds[index];
 }
 
-int SetSceneNodeName(SceneNodeId sceneNodeId, const char *name)
+BoundingBox GetSceneNodeSubtreeBounds(SceneNodeId sceneNodeId)
 {
-    SceneNode *node = GetSceneNode(sceneNodeId, 0);
-    if (!node)
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
     {
-        return 0;
+        return SCENE_EMPTY_BOUNDS;
     }
 
-    if (node->name)
+    return scene->nodeSubtreeBounds[index];
+}
+
+int SetSceneNodeName(SceneNodeId sceneNodeId, const char *name)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
     {
-        MemFree(node->name);
+        return 0;
     }
-    node->name = StringDup(name);
 
+    SetSceneNodeNameId(scene, index, name ? InternSceneName(scene, name, strlen(name)) : 0);
     return 1;
 }
 
 const char *GetSceneNodeName(SceneNodeId sceneNodeId)
 {
-    SceneNode *node = GetSceneNode(sceneNodeId, 0);
+    Scene *scene;
+    SceneNode *node = GetSceneNode(sceneNodeId, &scene, 0);
     if (!node)
     {
         return 0;
     }
 
-    return node->name;
+    return scene->names ? scene->names[node->nameId] : 0;
+}
+
+SceneNodeId FindSceneNodeByName(SceneId sceneId, const char *name)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene || !name)
+    {
+        return (SceneNodeId){0};
+    }
+
+    unsigned int nameId = LookupSceneName(scene, name, strlen(name));
+    unsigned int id = nameId ? FindSceneNameIndexEntry(scene, SCENE_NAME_ANY_PARENT, nameId) : SCENE_NODE_INDEX_NONE;
+    if (id == SCENE_NODE_INDEX_NONE)
+    {
+        return (SceneNodeId){0};
+    }
+
+    return (SceneNodeId){sceneId, id, scene->nodeIdGenerations[id]};
+}
+
+SceneNodeId FindSceneNodeChildByName(SceneNodeId parentSceneNodeId, const char *name)
+{
+    Scene *scene;
+    if (!name || !GetSceneNode(parentSceneNodeId, &scene, 0))
+    {
+        return (SceneNodeId){0};
+    }
+
+    unsigned int nameId = LookupSceneName(scene, name, strlen(name));
+    unsigned int id = nameId ? FindSceneNameIndexEntry(scene, parentSceneNodeId.id, nameId) : SCENE_NODE_INDEX_NONE;
+    if (id == SCENE_NODE_INDEX_NONE)
+    {
+        return (SceneNodeId){0};
+    }
+
+    return (SceneNodeId){parentSceneNodeId.sceneId, id, scene->nodeIdGenerations[id]};
+}
+
+SceneNodeId FindSceneNodeByPath(SceneId sceneId, const char *path)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene || !path)
+    {
+        return (SceneNodeId){0};
+    }
+
+    // the first name is looked up scene wide, the following ones among the children
+    unsigned int parentKey = SCENE_NAME_ANY_PARENT;
+    const char *name = path;
+    while (1)
+    {
+        const char *separator = strchr(name, '/');
+        unsigned long length = separator ? (unsigned long)(separator - name) : strlen(name);
+        unsigned int nameId = LookupSceneName(scene, name, length);
+        unsigned int id = nameId ? FindSceneNameIndexEntry(scene, parentKey, nameId) : SCENE_NODE_INDEX_NONE;
+        if (id == SCENE_NODE_INDEX_NONE)
+        {
+            return (SceneNodeId){0};
+        }
+
+        if (!separator)
+        {
+            return (SceneNodeId){sceneId, id, scene->nodeIdGenerations[id]};
+        }
+        parentKey = id;
+        name = separator + 1;
+    }
 }
 
 int GetSceneNodeIdentifier(SceneNodeId sceneNodeId)
 {
-    SceneNode *node = GetSceneNode(sceneNodeId, 0);
+    SceneNode *node = GetSceneNode(sceneNodeId, 0, 0);
     if (!node)
     {
         return 0;
@@ -825,7 +5152,7 @@ int GetSceneNodeIdentifier(SceneNodeId sceneNodeId)
 
 int SetSceneNodeIdentifier(SceneNodeId sceneNodeId, int identifier)
 {
-    SceneNode *node = GetSceneNode(sceneNodeId, 0);
+    SceneNode *node = GetSceneNode(sceneNodeId, 0, 0);
     if (!node)
     {
         return 0;
@@ -837,11 +5164,192 @@ int SetSceneNodeIdentifier(SceneNodeId sceneNodeId, int identifier)
 
 void SetSceneNodeModel(SceneNodeId sceneNodeId, SceneModelId model)
 {
-    SceneNode *node = GetSceneNode(sceneNodeId, 0);
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return;
+    }
+
+    // models are never removed from a scene, so the index stays valid once checked
+    int isValidModel = model.ownerSceneId.id == sceneNodeId.sceneId.id && model.ownerSceneId.generation == sceneNodeId.sceneId.generation &&
+        model.id < scene->modelsCount && scene->models[model.id].generation == model.generation;
+    scene->nodeModels[index] = isValidModel ? (int)model.id : -1;
+    UpdateSceneNodeBounds(scene, index);
+    if (scene->staticNodeCount > 0 && IsSceneNodeInStaticTree(scene, index))
+    {
+        scene->isStaticBVHDirty = 1;
+    }
+    else
+    {
+        MarkSceneNodeBVHDirty(scene, index);
+    }
+}
+
+SceneNodeComponentId AddSceneNodeComponent(SceneNodeId sceneNodeId, unsigned char definitionId, const void *data)
+{
+    Scene *scene;
+    unsigned int index;
+    if (!GetSceneNode(sceneNodeId, &scene, &index))
+    {
+        return (SceneNodeComponentId){0};
+    }
+
+    SceneNodeComponentDefinition *definition = &sceneNodeComponentDefinitions[definitionId];
+    if (!definition->name)
+    {
+        TraceLog(LOG_WARNING, "AddSceneNodeComponent: no component definition with id %d registered", definitionId);
+        return (SceneNodeComponentId){0};
+    }
+
+    return AddSceneComponent(scene, index, definitionId, data);
+}
+
+void RemoveSceneNodeComponent(SceneNodeComponentId componentId)
+{
+    Scene *scene;
+    if (!GetSceneComponentPool(componentId, &scene, 0))
+    {
+        return;
+    }
+
+    RemoveSceneComponent(scene, componentId.definitionId, (unsigned int)componentId.componentIndex);
+}
+
+void *GetSceneNodeComponent(SceneNodeComponentId componentId)
+{
+    unsigned int index;
+    SceneComponentData *pool = GetSceneComponentPool(componentId, 0, &index);
+    if (!pool)
+    {
+        return 0;
+    }
+
+    return pool->componentData + index * pool->componentDataSize;
+}
+
+SceneNodeId GetSceneNodeComponentNode(SceneNodeComponentId componentId)
+{
+    Scene *scene;
+    unsigned int index;
+    SceneComponentData *pool = GetSceneComponentPool(componentId, &scene, &index);
+    if (!pool)
+    {
+        return (SceneNodeId){0};
+    }
+
+    return GetSceneNodeIdOfId(scene, pool->componentNodeIds[index]);
+}
+
+SceneNodeComponentId FindSceneNodeComponent(SceneNodeId sceneNodeId, unsigned char definitionId)
+{
+    Scene *scene;
+    SceneNode *node = GetSceneNode(sceneNodeId, &scene, 0);
     if (!node)
+    {
+        return (SceneNodeComponentId){0};
+    }
+
+    for (unsigned int key = node->firstComponent; key != SCENE_NODE_INDEX_NONE;)
+    {
+        SceneComponentData *pool = &scene->sceneComponentData[key >> 24];
+        unsigned int slot = key & SCENE_COMPONENT_MAX_SLOTS;
+        if ((key >> 24) == definitionId)
+        {
+            return (SceneNodeComponentId){sceneNodeId.sceneId, slot, pool->slotGenerations[slot], definitionId};
+        }
+        key = pool->slotNextOfNode[slot];
+    }
+
+    return (SceneNodeComponentId){0};
+}
+
+void *GetSceneComponents(SceneId sceneId, unsigned char definitionId, unsigned long *count)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene)
+    {
+        *count = 0;
+        return 0;
+    }
+
+    SceneComponentData *pool = &scene->sceneComponentData[definitionId];
+    *count = pool->count;
+    return pool->componentData;
+}
+
+// components are handed to the batch callbacks in batches of this size at most
+#define SCENE_COMPONENT_BATCH_SIZE 256
+
+typedef struct SceneComponentBatchJob
+{
+    Scene *scene;
+    SceneComponentData *pool;
+    SceneComponentBatchCallback callback;
+    void *userData;
+} SceneComponentBatchJob;
+
+// gathers the node ids and world transforms of the components [start, start + count) batch by batch
+static void RunSceneComponentBatches(void *data, unsigned long start, unsigned long count)
+{
+    SceneComponentBatchJob *job = data;
+    Scene *scene = job->scene;
+    SceneComponentData *pool = job->pool;
+    SceneNodeId nodeIds[SCENE_COMPONENT_BATCH_SIZE];
+    Matrix worldTransforms[SCENE_COMPONENT_BATCH_SIZE];
+
+    unsigned long end = start + count;
+    for (unsigned long batchStart = start; batchStart < end; batchStart += SCENE_COMPONENT_BATCH_SIZE)
+    {
+        unsigned long batchCount = end - batchStart;
+        if (batchCount > SCENE_COMPONENT_BATCH_SIZE)
+        {
+            batchCount = SCENE_COMPONENT_BATCH_SIZE;
+        }
+
+        for (unsigned long i = 0; i < batchCount; i++)
+        {
+            unsigned int id = pool->componentNodeIds[batchStart + i];
+            nodeIds[i] = GetSceneNodeIdOfId(scene, id);
+            worldTransforms[i] = AffineToMatrix(scene->nodeLocalToWorld[scene->nodeIdIndices[id]]);
+        }
+
+        job->callback(pool->componentData + batchStart * pool->componentDataSize, nodeIds, worldTransforms, batchCount, job->userData);
+    }
+}
+
+static void RunSceneComponentBatchJob(SceneId sceneId, unsigned char definitionId, SceneComponentBatchCallback callback, void *userData, int isParallel)
+{
+    Scene *scene = GetScene(sceneId);
+    if (!scene || scene->sceneComponentData[definitionId].count == 0)
     {
         return;
     }
 
-    node->model = model;
-}
\ No newline at end of file
+    // the world transforms are brought up to date here, since the batches may run on other threads
+    SceneComponentData *pool = &scene->sceneComponentData[definitionId];
+    for (unsigned long i = 0; i < pool->count; i++)
+    {
+        UpdateSceneNodeTRS(scene, scene->nodeIdIndices[pool->componentNodeIds[i]]);
+    }
+
+    SceneComponentBatchJob job = {scene, pool, callback, userData};
+    if (isParallel)
+    {
+        RunSceneJob(RunSceneComponentBatches, &job, pool->count);
+    }
+    else
+    {
+        RunSceneComponentBatches(&job, 0, pool->count);
+    }
+}
+
+void ForEachSceneComponentBatch(SceneId sceneId, unsigned char definitionId, SceneComponentBatchCallback callback, void *userData)
+{
+    RunSceneComponentBatchJob(sceneId, definitionId, callback, userData, 0);
+}
+
+void ForEachSceneComponentBatchParallel(SceneId sceneId, unsigned char definitionId, SceneComponentBatchCallback callback, void *userData)
+{
+    RunSceneComponentBatchJob(sceneId, definitionId, callback, userData, 1);
+}
@@ -26,6 +26,11 @@ Secondary goals:
 #define SCENE_DRAW_SORT_BACK_TO_FRONT 2
 #define SCENE_DRAW_SORT_HIERARCHY 3
 
+// spread transform updates over a worker pool; worth it for scenes with many thousands of moving nodes
+#define SCENE_FLAG_PARALLEL_TRANSFORMS 1
+// record the nodes whose world transform changed, see GetSceneChangedNodes
+#define SCENE_FLAG_RECORD_CHANGES 2
+
 typedef struct SceneId {
     unsigned long id;
     long generation;
@@ -37,6 +42,11 @@ typedef struct SceneNodeId {
     long generation;
 } SceneNodeId;
 
+// packed 8 byte node handle: bits 0-31 hold the node index, bits 32-47 the node generation,
+// bits 48-55 the scene generation and bits 56-63 the scene slot. Generations are wrapped,
+// so a handle is cheap to store and to validate; SceneNodeId remains the primary API type.
+typedef unsigned long long SceneNodeHandle;
+
 typedef struct SceneModelId {
     // models can be shared between scenes
     SceneId ownerSceneId;
@@ -72,6 +82,11 @@ typedef struct SceneNodeComponentDefinition {
 
 typedef struct SceneDrawConfig {
     Camera3D camera;
+    // projection used for culling; 0 selects the defaults of BeginMode3D for the near and far
+    // planes and the screen's aspect ratio. Render texture views should set their own aspect
+    float aspect;
+    float nearPlane;
+    float farPlane;
     Matrix transform;
     unsigned long layerMask;
     unsigned char sortMode;
@@ -83,21 +98,119 @@ typedef struct SceneDrawStats {
     unsigned long culledMeshCount;
     unsigned long meshDrawCount;
     unsigned long trianglesDrawCount;
+    // culling stages: meshes decided by their bounding sphere and those that needed the box test
+    unsigned long sphereCulledMeshCount;
+    unsigned long sphereAcceptedMeshCount;
+    unsigned long boxTestedMeshCount;
+    // subtrees rejected or accepted as a whole by their bounds; their meshes skip the tests above
+    unsigned long culledSubtreeCount;
+    unsigned long acceptedSubtreeCount;
+    // inner nodes of intersecting subtrees rejected by the world bounds of their own model
+    unsigned long culledNodeCount;
 } SceneDrawStats;
 
+// world space boxes given by their centers and half extents, with one array per component
+typedef struct SceneBoxArrays {
+    const float *centerX;
+    const float *centerY;
+    const float *centerZ;
+    const float *extentX;
+    const float *extentY;
+    const float *extentZ;
+} SceneBoxArrays;
+
+// allocation callbacks for all memory of a scene; userData is passed to every call, and the
+// allocated memory doesn't need to be zeroed.
+// Without callbacks and with an arenaSize, the scene uses a built-in linear arena that
+// allocates blocks of arenaSize bytes instead. Arena memory is only given back when the
+// scene is unloaded, which then takes one free per block. Reserving the nodes up front with
+// ReserveSceneNodes avoids leaving outgrown node arrays behind in the arena.
+// An arena of fresh blocks makes loading and unloading slower than the default allocator, as
+// the blocks are mapped and paged in anew for every scene. The arena only pays off when the
+// same arenaMemory is reused from one scene to the next
+typedef struct SceneAllocator {
+    void *(*allocate)(void *userData, unsigned long size);
+    void *(*reallocate)(void *userData, void *memory, unsigned long size);
+    void (*release)(void *userData, void *memory);
+    void *userData;
+    unsigned long arenaSize;
+    // optional caller owned memory of arenaSize bytes that serves as the first arena block,
+    // so consecutive levels can reuse the same block. It must be aligned to 16 bytes, or it is
+    // ignored with a warning, and stay valid until the scene is unloaded; it needn't be zeroed
+    void *arenaMemory;
+} SceneAllocator;
+
+// receives count components of one definition: their packed data, the ids of their nodes and
+// the world transforms of those nodes. The arrays are only valid during the call
+typedef void (*SceneComponentBatchCallback)(void *componentData, const SceneNodeId *nodeIds, const Matrix *worldTransforms, unsigned long count, void *userData);
+
 void RegisterSceneNodeComponent(SceneNodeComponentDefinition definition);
 
 // creates a new empty scene
 SceneId LoadScene();
+// creates a new empty scene that allocates its memory through the allocator
+SceneId LoadSceneEx(SceneAllocator allocator);
 void UnloadScene(SceneId sceneId);
 int IsSceneValid(SceneId sceneId);
+// SCENE_FLAG_* bits
+void SetSceneFlags(SceneId sceneId, unsigned int flags);
+unsigned int GetSceneFlags(SceneId sceneId);
 SceneDrawStats DrawScene(SceneId sceneId, SceneDrawConfig config);
+// view-projection matrix of the config's camera with its perspective or orthographic projection,
+// as DrawScene culls with it; doesn't require a window if the aspect is set
+Matrix GetSceneViewProjection(SceneDrawConfig config);
+// extracts the near, far, right, left, top and bottom planes of the view-projection matrix.
+// Each plane is stored as its inward normal and w, so points inside have dot(normal, point) >= w
+void GetSceneFrustumPlanes(Matrix viewProjection, Vector4 *planes);
+// returns 0 if the box, transformed by the matrix, is entirely outside one of the planes
+int CheckCollisionBoxFrustum(BoundingBox box, Vector4 *planes, Matrix transform);
+// tests count boxes against the planes, several per iteration with SIMD support, and writes the
+// indices of those not entirely outside one of them to visibleIndices in increasing order.
+// visibleIndices needs room for count indices. Returns the number of visible boxes
+unsigned long CullSceneBoxes(SceneBoxArrays boxes, unsigned long count, Vector4 *planes, unsigned int *visibleIndices);
+// spatial queries over the world bounds of the nodes with models, as of the last UpdateSceneTransforms.
+// Returns the nearest node whose bounds the ray hits, with the hit on the bounds
+RayCollision GetRayCollisionScene(SceneId sceneId, Ray ray, SceneNodeId *sceneNodeId);
+// store up to maxCount nodes whose bounds overlap the box or sphere and return how many there are in total
+int FindSceneNodesInBox(SceneId sceneId, BoundingBox box, SceneNodeId *sceneNodeIds, int maxCount);
+int FindSceneNodesInSphere(SceneId sceneId, Vector3 center, float radius, SceneNodeId *sceneNodeIds, int maxCount);
+// brings the spatial index in line with the last UpdateSceneTransforms. The queries do this on their
+// own, but the first one after loading a level builds the trees, and the first one after many nodes
+// moved refits them, which takes far longer than a query; calling this at a convenient time, such as
+// right after loading, keeps that work out of a frame that queries
+void UpdateSceneSpatialIndex(SceneId sceneId);
 SceneModelId AddModelToScene(SceneId sceneId, Model model, const char* name, int manageModel);
 void TraverseSceneNodes(SceneId sceneId, void (*callback)(SceneNodeId, void*), void* data);
+// recomputes all dirty world transforms in parent-before-child order; DrawScene calls this
+void UpdateSceneTransforms(SceneId sceneId);
+// with SCENE_FLAG_RECORD_CHANGES, every node whose world transform got recomputed is listed once
+// until ClearSceneChangedNodes is called, typically at the end of a frame. Handles of nodes released
+// meanwhile fail IsSceneNodeHandleValid. The list is valid until the next transform update
+const SceneNodeHandle *GetSceneChangedNodes(SceneId sceneId, unsigned long *count);
+void ClearSceneChangedNodes(SceneId sceneId);
+// moves the live nodes into depth first order without gaps and shrinks the node storage to fit,
+// so traversals of a scene with a lot of node churn touch contiguous memory again.
+// SceneNodeIds and SceneNodeHandles stay valid. Takes time linear in the node count
+void CompactScene(SceneId sceneId);
+// clones the subtree of the template node, including transforms, models, names, static flags
+// and components, and attaches the clone to the parent or makes it a root if the parent is
+// (SceneNodeId){0}. The parent must be in the same scene. Returns the root of the clone
+SceneNodeId InstantiateSceneNodeSubtree(SceneNodeId templateSceneNodeId, SceneNodeId parentSceneNodeId);
 
 SceneNodeId AcquireSceneNode(SceneId sceneId);
+// makes room for count more nodes, so acquiring them doesn't reallocate the node storage
+void ReserveSceneNodes(SceneId sceneId, unsigned long count);
+// acquires count root nodes at once and writes their ids to sceneNodeIds; returns the number of acquired nodes
+int AcquireSceneNodes(SceneId sceneId, int count, SceneNodeId *sceneNodeIds);
+// same as AcquireSceneNodes, but attaches the nodes to the parent, unless it is (SceneNodeId){0}
+int AcquireSceneNodesEx(SceneId sceneId, int count, SceneNodeId parentSceneNodeId, SceneNodeId *sceneNodeIds);
 void ReleaseSceneNode(SceneNodeId sceneNodeId);
+// releases the node and all its descendants in a single linear pass; same as ReleaseSceneNode
+void ReleaseSceneNodeSubtree(SceneNodeId sceneNodeId);
 int IsSceneNodeValid(SceneNodeId sceneNodeId);
+SceneNodeHandle GetSceneNodeHandle(SceneNodeId sceneNodeId);
+SceneNodeId GetSceneNodeIdFromHandle(SceneNodeHandle handle);
+int IsSceneNodeHandleValid(SceneNodeHandle handle);
 
 void SetSceneNodeParent(SceneNodeId sceneNodeId, SceneNodeId parentSceneNodeId);
 SceneNodeId GetSceneNodeFirstRoot(SceneNodeId sceneNodeId);
@@ -111,25 +224,76 @@ void SetSceneNodeScale(SceneNodeId sceneNodeId, float x, float y, float z);
 void SetSceneNodePositionV(SceneNodeId sceneNodeId, Vector3 position);
 void SetSceneNodeRotationV(SceneNodeId sceneNodeId, Vector3 rotation);
 void SetSceneNodeScaleV(SceneNodeId sceneNodeId, Vector3 scale);
+// stores the rotation as quaternion (expected to be normalized), which is cheaper to update than euler angles
+void SetSceneNodeRotationQ(SceneNodeId sceneNodeId, Quaternion rotation);
+// sets the transforms of count nodes with a single validation pass; positions, rotations (euler degrees)
+// and scales may each be NULL to keep that part. Invalid nodes are skipped; returns the number of updated nodes
+int SetSceneNodeTransformsBatch(const SceneNodeId *sceneNodeIds, const Vector3 *positions, const Vector3 *rotations, const Vector3 *scales, int count);
+
+// freezes the node and its subtree: the world transforms are baked now and skipped by transform
+// updates until the node is made dynamic again. Transform changes made to a static subtree, or to
+// its ancestors, take effect when it becomes dynamic
+void SetSceneNodeStatic(SceneNodeId sceneNodeId, int isStatic);
+// returns 1 if the node or one of its ancestors is static
+int IsSceneNodeStatic(SceneNodeId sceneNodeId);
 
 Matrix GetSceneNodeLocalTransform(SceneNodeId sceneNodeId);
+Matrix GetSceneNodeWorldToLocalTransform(SceneNodeId sceneNodeId);
+// writes the localToWorld matrices of count nodes into matrices; invalid nodes get the identity.
+// Returns the number of valid nodes
+int GetSceneNodeWorldMatricesBatch(const SceneNodeId *sceneNodeIds, Matrix *matrices, int count);
+// transforms count points between the node's local space and world space; points and result may be the same array
+void TransformSceneNodePointsToWorld(SceneNodeId sceneNodeId, const Vector3 *points, Vector3 *result, int count);
+void TransformSceneNodePointsToLocal(SceneNodeId sceneNodeId, const Vector3 *points, Vector3 *result, int count);
 
 Vector3 GetSceneNodeLocalPosition(SceneNodeId sceneNodeId);
 Vector3 GetSceneNodeLocalRotation(SceneNodeId sceneNodeId);
 Vector3 GetSceneNodeLocalScale(SceneNodeId sceneNodeId);
+Quaternion GetSceneNodeLocalRotationQ(SceneNodeId sceneNodeId);
 Vector3 GetSceneNodeWorldPosition(SceneNodeId sceneNodeId);
 Vector3 GetSceneNodeWorldForward(SceneNodeId sceneNodeId);
 Vector3 GetSceneNodeWorldUp(SceneNodeId sceneNodeId);
 Vector3 GetSceneNodeWorldRight(SceneNodeId sceneNodeId);
+// world space bounds of the node's model and of the models in its whole subtree, as of the last
+// UpdateSceneTransforms. Nodes without meshes return bounds with min greater than max
+BoundingBox GetSceneNodeWorldBounds(SceneNodeId sceneNodeId);
+BoundingBox GetSceneNodeSubtreeBounds(SceneNodeId sceneNodeId);
 
+// names are interned per scene; the returned string stays valid until the scene is unloaded
 int SetSceneNodeName(SceneNodeId sceneNodeId, const char* name);
 const char* GetSceneNodeName(SceneNodeId sceneNodeId);
+// hash lookups of named nodes in constant time; if several nodes match, any of them is returned.
+// Return (SceneNodeId){0} if no node matches
+SceneNodeId FindSceneNodeByName(SceneId sceneId, const char* name);
+SceneNodeId FindSceneNodeChildByName(SceneNodeId parentSceneNodeId, const char* name);
+// finds a node by a path like "biplane/propeller": the first name is looked up in the whole
+// scene, every following one among the children of the previous node
+SceneNodeId FindSceneNodeByPath(SceneId sceneId, const char* path);
 
 int GetSceneNodeIdentifier(SceneNodeId sceneNodeId);
 int SetSceneNodeIdentifier(SceneNodeId sceneNodeId, int identifier);
 
 void SetSceneNodeModel(SceneNodeId sceneNodeId, SceneModelId model);
 
+// attaches a component of a registered definition to the node; data is copied into the component
+// or it is zeroed if data is 0. Components are removed along with their node. The onAdd and
+// onRemove callbacks must not add or remove components or nodes
+SceneNodeComponentId AddSceneNodeComponent(SceneNodeId sceneNodeId, unsigned char definitionId, const void* data);
+void RemoveSceneNodeComponent(SceneNodeComponentId componentId);
+// returns the component's data; the pointer is valid until a component of the same definition is added or removed
+void* GetSceneNodeComponent(SceneNodeComponentId componentId);
+SceneNodeId GetSceneNodeComponentNode(SceneNodeComponentId componentId);
+// returns a component of the definition attached to the node or (SceneNodeComponentId){0}
+SceneNodeComponentId FindSceneNodeComponent(SceneNodeId sceneNodeId, unsigned char definitionId);
+// returns the data of all components of the definition, packed by componentDataSize in no particular order
+void* GetSceneComponents(SceneId sceneId, unsigned char definitionId, unsigned long* count);
+// calls the callback with consecutive batches of all components of the definition; the callback
+// may modify the component data but must not add or remove components or nodes
+void ForEachSceneComponentBatch(SceneId sceneId, unsigned char definitionId, SceneComponentBatchCallback callback, void* userData);
+// same as ForEachSceneComponentBatch, but the batches are spread over the worker pool, so the
+// callback runs on several threads at once and must not call into the scene API
+void ForEachSceneComponentBatchParallel(SceneId sceneId, unsigned char definitionId, SceneComponentBatchCallback callback, void* userData);
+
 void AddGLTFScene(SceneId sceneId, const char* filename, Matrix transform);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,952 @@
+#include "raylib.h"
+#include "raymath.h"
+#include "scene.h"
+#include <stdio.h>
+#include <string.h>
+
+// Scene graph benchmarks; run from the repository root so the resources can be found.
+// A hidden window is opened only because loading models requires a GL context;
+// the measured sections don't issue any draw calls.
+
+#define BENCH_NODE_COUNT 100000
+#define BENCH_PATCH_SIZE 50
+#define BENCH_FRAMES 100
+#define BENCH_PARALLEL_NODE_COUNT 200000
+#define BENCH_QUERY_COUNT 1000
+#define BENCH_BRUTE_QUERY_COUNT 20
+#define BENCH_CULL_BOX_COUNT 1000000
+#define BENCH_CULL_FRAMES 10
+
+static SceneNodeId CreateTreePatch(SceneId sceneId, SceneModelId modelId, int count)
+{
+    SceneNodeId root = AcquireSceneNode(sceneId);
+
+    for (int i = 0; i < count; i++)
+    {
+        SceneNodeId firTreeNodeId = AcquireSceneNode(sceneId);
+        SetSceneNodeModel(firTreeNodeId, modelId);
+        float rx = GetRandomValue(-400, 400) * 0.01f;
+        float rz = GetRandomValue(-400, 400) * 0.01f;
+        SetSceneNodePosition(firTreeNodeId, rx, 0, rz);
+        float scale = GetRandomValue(90, 110) * 0.01f;
+        SetSceneNodeScale(firTreeNodeId, scale, scale, scale);
+        SetSceneNodeRotation(firTreeNodeId, 0, GetRandomValue(0, 360), 0);
+        SetSceneNodeParent(firTreeNodeId, root);
+    }
+
+    return root;
+}
+
+static void BenchTransformsAndCulling(Model firTree)
+{
+    SceneId sceneId = LoadScene();
+    SceneModelId firTreeId = AddModelToScene(sceneId, firTree, "fir tree", 0);
+
+    int patchCount = BENCH_NODE_COUNT / (BENCH_PATCH_SIZE + 1);
+    SceneNodeId *patches = MemAlloc(sizeof(SceneNodeId) * patchCount);
+    for (int i = 0; i < patchCount; i++)
+    {
+        patches[i] = CreateTreePatch(sceneId, firTreeId, BENCH_PATCH_SIZE);
+    }
+
+    // moving every patch root dirties all nodes of the scene
+    double start = GetTime();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        for (int i = 0; i < patchCount; i++)
+        {
+            SetSceneNodePosition(patches[i], (i % 64) * 8.0f, frame * 0.01f, (i / 64) * 8.0f);
+        }
+        UpdateSceneTransforms(sceneId);
+    }
+    double transformTime = (GetTime() - start) / BENCH_FRAMES;
+
+    // nothing is dirty: this only measures walking the node data
+    start = GetTime();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        UpdateSceneTransforms(sceneId);
+    }
+    double cleanTransformTime = (GetTime() - start) / BENCH_FRAMES;
+
+    // the camera looks away from the scene, so every mesh is culled and nothing gets drawn
+    Camera3D camera = { 0 };
+    camera.position = (Vector3){ 0.0f, -50.0f, 0.0f };
+    camera.target = (Vector3){ 0.0f, -100.0f, 0.0f };
+    camera.up = (Vector3){ 0.0f, 0.0f, 1.0f };
+    camera.fovy = 35.0f;
+    camera.projection = CAMERA_PERSPECTIVE;
+
+    SceneDrawStats drawStats = { 0 };
+    start = GetTime();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        drawStats = DrawScene(sceneId, (SceneDrawConfig) { .camera = camera,
+            .transform = MatrixIdentity(), .layerMask = 0, .sortMode = SCENE_DRAW_SORT_NONE });
+    }
+    double cullTime = (GetTime() - start) / BENCH_FRAMES;
+
+    // the camera sees a corner of the forest: most patches are rejected as a whole, the visible
+    // ones are drawn without testing their meshes one by one
+    camera.position = (Vector3){ -20.0f, 30.0f, -20.0f };
+    camera.target = (Vector3){ 60.0f, 0.0f, 60.0f };
+    camera.up = (Vector3){ 0.0f, 1.0f, 0.0f };
+    camera.fovy = 45.0f;
+
+    SceneDrawStats partialStats = { 0 };
+    start = GetTime();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        partialStats = DrawScene(sceneId, (SceneDrawConfig) { .camera = camera, .farPlane = 200.0f,
+            .transform = MatrixIdentity(), .layerMask = 0, .sortMode = SCENE_DRAW_SORT_NONE });
+    }
+    double partialCullTime = (GetTime() - start) / BENCH_FRAMES;
+
+    int nodeCount = patchCount * (BENCH_PATCH_SIZE + 1);
+    printf("transform update: %d nodes, %.3f ms/frame, %.1f ns/node\n",
+        nodeCount, transformTime * 1000.0, transformTime * 1e9 / nodeCount);
+    printf("clean update:     %d nodes, %.3f ms/frame, %.1f ns/node\n",
+        nodeCount, cleanTransformTime * 1000.0, cleanTransformTime * 1e9 / nodeCount);
+    printf("culling:          %lu meshes culled, %.3f ms/frame (%lu by sphere, %lu box tests)\n",
+        drawStats.culledMeshCount, cullTime * 1000.0, drawStats.sphereCulledMeshCount, drawStats.boxTestedMeshCount);
+    printf("partial view:     %lu meshes drawn, %lu culled, %.3f ms/frame (%lu subtrees culled, %lu accepted, %lu nodes culled)\n",
+        partialStats.meshDrawCount, partialStats.culledMeshCount, partialCullTime * 1000.0,
+        partialStats.culledSubtreeCount, partialStats.acceptedSubtreeCount, partialStats.culledNodeCount);
+
+    MemFree(patches);
+    UnloadScene(sceneId);
+}
+
+// the box test on its own, with random transformed boxes of which about half are visible
+static void BenchBoxFrustumTests(void)
+{
+    SceneDrawConfig config = { .camera = { .position = { 0.0f, 5.0f, 20.0f }, .target = { 0.0f, 0.0f, 0.0f },
+        .up = { 0.0f, 1.0f, 0.0f }, .fovy = 45.0f, .projection = CAMERA_PERSPECTIVE }, .aspect = 16.0f / 9.0f, .farPlane = 60.0f };
+    Vector4 planes[6];
+    GetSceneFrustumPlanes(GetSceneViewProjection(config), planes);
+
+    Matrix *transforms = MemAlloc(sizeof(Matrix) * BENCH_NODE_COUNT);
+    for (int i = 0; i < BENCH_NODE_COUNT; i++)
+    {
+        Matrix rotation = MatrixRotateXYZ((Vector3){ GetRandomValue(0, 628) * 0.01f, GetRandomValue(0, 628) * 0.01f, 0.0f });
+        transforms[i] = MatrixMultiply(rotation, MatrixTranslate(GetRandomValue(-400, 400) * 0.1f, 0.0f, GetRandomValue(-400, 400) * 0.1f));
+    }
+    BoundingBox box = { { -0.5f, 0.0f, -0.5f }, { 0.5f, 2.0f, 0.5f } };
+
+    int visibleCount = 0;
+    double start = GetTime();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        visibleCount = 0;
+        for (int i = 0; i < BENCH_NODE_COUNT; i++)
+        {
+            visibleCount += CheckCollisionBoxFrustum(box, planes, transforms[i]);
+        }
+    }
+    double time = (GetTime() - start) / BENCH_FRAMES;
+
+    printf("box tests:        %d boxes, %d visible, %.3f ms, %.1f ns/box\n", BENCH_NODE_COUNT, visibleCount,
+        time * 1000.0, time * 1e9 / BENCH_NODE_COUNT);
+
+    MemFree(transforms);
+}
+
+// world space boxes culled from packed arrays, compared with testing the same boxes one by one
+static void BenchPackedBoxCulling(void)
+{
+    SceneDrawConfig config = { .camera = { .position = { 0.0f, 5.0f, 20.0f }, .target = { 0.0f, 0.0f, 0.0f },
+        .up = { 0.0f, 1.0f, 0.0f }, .fovy = 45.0f, .projection = CAMERA_PERSPECTIVE }, .aspect = 16.0f / 9.0f, .farPlane = 60.0f };
+    Vector4 planes[6];
+    GetSceneFrustumPlanes(GetSceneViewProjection(config), planes);
+
+    float *components = MemAlloc(sizeof(float) * BENCH_CULL_BOX_COUNT * 6);
+    SceneBoxArrays boxes = { components, components + BENCH_CULL_BOX_COUNT, components + BENCH_CULL_BOX_COUNT * 2,
+        components + BENCH_CULL_BOX_COUNT * 3, components + BENCH_CULL_BOX_COUNT * 4, components + BENCH_CULL_BOX_COUNT * 5 };
+    BoundingBox *boundingBoxes = MemAlloc(sizeof(BoundingBox) * BENCH_CULL_BOX_COUNT);
+    unsigned int *visibleIndices = MemAlloc(sizeof(unsigned int) * BENCH_CULL_BOX_COUNT);
+    for (int i = 0; i < BENCH_CULL_BOX_COUNT; i++)
+    {
+        Vector3 center = { GetRandomValue(-400, 400) * 0.1f, GetRandomValue(0, 100) * 0.1f, GetRandomValue(-400, 400) * 0.1f };
+        Vector3 extent = { GetRandomValue(1, 10) * 0.1f, GetRandomValue(1, 20) * 0.1f, GetRandomValue(1, 10) * 0.1f };
+        components[i] = center.x;
+        components[BENCH_CULL_BOX_COUNT + i] = center.y;
+        components[BENCH_CULL_BOX_COUNT * 2 + i] = center.z;
+        components[BENCH_CULL_BOX_COUNT * 3 + i] = extent.x;
+        components[BENCH_CULL_BOX_COUNT * 4 + i] = extent.y;
+        components[BENCH_CULL_BOX_COUNT * 5 + i] = extent.z;
+        boundingBoxes[i] = (BoundingBox){ Vector3Subtract(center, extent), Vector3Add(center, extent) };
+    }
+
+    unsigned long visibleCount = 0;
+    double start = GetTime();
+    for (int frame = 0; frame < BENCH_CULL_FRAMES; frame++)
+    {
+        visibleCount = CullSceneBoxes(boxes, BENCH_CULL_BOX_COUNT, planes, visibleIndices);
+    }
+    double packedTime = (GetTime() - start) / BENCH_CULL_FRAMES;
+
+    unsigned long singleVisibleCount = 0;
+    start = GetTime();
+    for (int frame = 0; frame < BENCH_CULL_FRAMES; frame++)
+    {
+        singleVisibleCount = 0;
+        for (int i = 0; i < BENCH_CULL_BOX_COUNT; i++)
+        {
+            if (CheckCollisionBoxFrustum(boundingBoxes[i], planes, MatrixIdentity()))
+            {
+                visibleIndices[singleVisibleCount++] = i;
+            }
+        }
+    }
+    double singleTime = (GetTime() - start) / BENCH_CULL_FRAMES;
+
+    printf("packed culling:   %d boxes, %lu visible, %.1f M boxes/s packed, %.1f M boxes/s one by one (%lu visible)\n",
+        BENCH_CULL_BOX_COUNT, visibleCount, BENCH_CULL_BOX_COUNT / packedTime / 1e6, BENCH_CULL_BOX_COUNT / singleTime / 1e6,
+        singleVisibleCount);
+
+    MemFree(visibleIndices);
+    MemFree(boundingBoxes);
+    MemFree(components);
+}
+
+#define BENCH_TRANSFORM_GENERAL 0
+#define BENCH_TRANSFORM_ROTATION_Y 1
+#define BENCH_TRANSFORM_TRANSLATION 2
+
+// throughput of composing local matrices and multiplying them with the parent matrix,
+// for children with a general transform, a rotation around y only or a translation only
+static void BenchComposeMatrices(int kind)
+{
+    SceneId sceneId = LoadScene();
+
+    int rootCount = 100;
+    int childCount = BENCH_NODE_COUNT / rootCount - 1;
+    SceneNodeId *roots = MemAlloc(sizeof(SceneNodeId) * rootCount);
+    for (int i = 0; i < rootCount; i++)
+    {
+        roots[i] = AcquireSceneNode(sceneId);
+        for (int j = 0; j < childCount; j++)
+        {
+            SceneNodeId child = AcquireSceneNode(sceneId);
+            SetSceneNodePosition(child, j * 0.1f, 0, 0);
+            if (kind == BENCH_TRANSFORM_GENERAL)
+            {
+                SetSceneNodeRotation(child, j * 7.0f, j * 13.0f, j * 3.0f);
+                SetSceneNodeScale(child, 1.0f, 1.0f + j * 0.001f, 1.0f);
+            }
+            else if (kind == BENCH_TRANSFORM_ROTATION_Y)
+            {
+                float scale = 1.0f + j * 0.001f;
+                SetSceneNodeRotation(child, 0, j * 13.0f, 0);
+                SetSceneNodeScale(child, scale, scale, scale);
+            }
+            SetSceneNodeParent(child, roots[i]);
+        }
+    }
+
+    double start = GetTime();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        for (int i = 0; i < rootCount; i++)
+        {
+            SetSceneNodeRotation(roots[i], 0, frame * 2.0f, 0);
+        }
+        UpdateSceneTransforms(sceneId);
+    }
+    double time = GetTime() - start;
+
+    double matrices = (double)rootCount * (childCount + 1) * BENCH_FRAMES;
+    const char *kindNames[] = { "general", "rotation y", "translation" };
+    printf("compose matrices: %.1f M matrices/s, %s\n", matrices / time / 1e6, kindNames[kind]);
+
+    MemFree(roots);
+    UnloadScene(sceneId);
+}
+
+// a tenth of the patches move every frame while the rest are level geometry, first all
+// dynamic and then with the unmoving patches made static
+static void BenchStaticSubtrees(Model firTree)
+{
+    SceneId sceneId = LoadScene();
+    SceneModelId firTreeId = AddModelToScene(sceneId, firTree, "fir tree", 0);
+
+    int patchCount = BENCH_NODE_COUNT / (BENCH_PATCH_SIZE + 1);
+    SceneNodeId *patches = MemAlloc(sizeof(SceneNodeId) * patchCount);
+    for (int i = 0; i < patchCount; i++)
+    {
+        patches[i] = CreateTreePatch(sceneId, firTreeId, BENCH_PATCH_SIZE);
+    }
+
+    double times[2];
+    for (int useStatic = 0; useStatic < 2; useStatic++)
+    {
+        for (int i = 0; i < patchCount; i++)
+        {
+            SetSceneNodeStatic(patches[i], useStatic && i % 10 != 0);
+        }
+        UpdateSceneTransforms(sceneId);
+
+        double start = GetTime();
+        for (int frame = 0; frame < BENCH_FRAMES; frame++)
+        {
+            for (int i = 0; i < patchCount; i += 10)
+            {
+                SetSceneNodePosition(patches[i], (i % 64) * 8.0f, frame * 0.01f, (i / 64) * 8.0f);
+            }
+            UpdateSceneTransforms(sceneId);
+        }
+        times[useStatic] = (GetTime() - start) / BENCH_FRAMES;
+    }
+
+    int nodeCount = patchCount * (BENCH_PATCH_SIZE + 1);
+    printf("10%% moving:       %d nodes, %.3f ms/frame all dynamic, %.3f ms/frame rest static\n",
+        nodeCount, times[0] * 1000.0, times[1] * 1000.0);
+
+    MemFree(patches);
+    UnloadScene(sceneId);
+}
+
+// spawning a level's worth of nodes into a fresh scene, one by one and in bulk
+static void BenchAcquireNodes(void)
+{
+    SceneNodeId *nodes = MemAlloc(sizeof(SceneNodeId) * BENCH_NODE_COUNT);
+
+    double times[2] = { 0 };
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        SceneId sceneId = LoadScene();
+        double start = GetTime();
+        for (int i = 0; i < BENCH_NODE_COUNT; i++)
+        {
+            nodes[i] = AcquireSceneNode(sceneId);
+        }
+        times[0] += GetTime() - start;
+        UnloadScene(sceneId);
+
+        sceneId = LoadScene();
+        start = GetTime();
+        ReserveSceneNodes(sceneId, BENCH_NODE_COUNT);
+        AcquireSceneNodes(sceneId, BENCH_NODE_COUNT, nodes);
+        times[1] += GetTime() - start;
+        UnloadScene(sceneId);
+    }
+
+    printf("acquire nodes:    %d nodes, %.3f ms single, %.3f ms bulk\n", BENCH_NODE_COUNT,
+        times[0] * 1000.0 / BENCH_FRAMES, times[1] * 1000.0 / BENCH_FRAMES);
+
+    MemFree(nodes);
+}
+
+// per-call overhead of the setters and getters compared to their batch versions;
+// the transform update itself is not timed
+static void BenchBatchSetters(void)
+{
+    SceneId sceneId = LoadScene();
+
+    SceneNodeId *nodes = MemAlloc(sizeof(SceneNodeId) * BENCH_NODE_COUNT);
+    Vector3 *positions = MemAlloc(sizeof(Vector3) * BENCH_NODE_COUNT);
+    Matrix *matrices = MemAlloc(sizeof(Matrix) * BENCH_NODE_COUNT);
+    for (int i = 0; i < BENCH_NODE_COUNT; i++)
+    {
+        nodes[i] = AcquireSceneNode(sceneId);
+        positions[i] = (Vector3){ i * 0.1f, 0, 0 };
+    }
+
+    double times[4] = { 0 };
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        double start = GetTime();
+        for (int i = 0; i < BENCH_NODE_COUNT; i++)
+        {
+            SetSceneNodePositionV(nodes[i], positions[i]);
+        }
+        times[0] += GetTime() - start;
+        UpdateSceneTransforms(sceneId);
+
+        start = GetTime();
+        for (int i = 0; i < BENCH_NODE_COUNT; i++)
+        {
+            matrices[i] = GetSceneNodeLocalTransform(nodes[i]);
+        }
+        times[1] += GetTime() - start;
+
+        start = GetTime();
+        SetSceneNodeTransformsBatch(nodes, positions, 0, 0, BENCH_NODE_COUNT);
+        times[2] += GetTime() - start;
+        UpdateSceneTransforms(sceneId);
+
+        start = GetTime();
+        GetSceneNodeWorldMatricesBatch(nodes, matrices, BENCH_NODE_COUNT);
+        times[3] += GetTime() - start;
+    }
+
+    printf("set positions:    %.3f ms/frame single, %.3f ms/frame batch\n",
+        times[0] * 1000.0 / BENCH_FRAMES, times[2] * 1000.0 / BENCH_FRAMES);
+    printf("get matrices:     %.3f ms/frame single, %.3f ms/frame batch\n",
+        times[1] * 1000.0 / BENCH_FRAMES, times[3] * 1000.0 / BENCH_FRAMES);
+
+    MemFree(matrices);
+    MemFree(positions);
+    MemFree(nodes);
+    UnloadScene(sceneId);
+}
+
+// all-dirty updates of the same tree patches, serial and with SCENE_FLAG_PARALLEL_TRANSFORMS
+static void BenchParallelTransforms(Model firTree)
+{
+    SceneId sceneId = LoadScene();
+    SceneModelId firTreeId = AddModelToScene(sceneId, firTree, "fir tree", 0);
+
+    int patchCount = BENCH_PARALLEL_NODE_COUNT / (BENCH_PATCH_SIZE + 1);
+    SceneNodeId *patches = MemAlloc(sizeof(SceneNodeId) * patchCount);
+    for (int i = 0; i < patchCount; i++)
+    {
+        patches[i] = CreateTreePatch(sceneId, firTreeId, BENCH_PATCH_SIZE);
+    }
+
+    double times[2];
+    for (int parallel = 0; parallel < 2; parallel++)
+    {
+        SetSceneFlags(sceneId, parallel ? SCENE_FLAG_PARALLEL_TRANSFORMS : 0);
+        double start = GetTime();
+        for (int frame = 0; frame < BENCH_FRAMES; frame++)
+        {
+            for (int i = 0; i < patchCount; i++)
+            {
+                SetSceneNodeRotation(patches[i], 0, frame * 2.0f, 0);
+            }
+            UpdateSceneTransforms(sceneId);
+        }
+        times[parallel] = (GetTime() - start) / BENCH_FRAMES;
+    }
+
+    int nodeCount = patchCount * (BENCH_PATCH_SIZE + 1);
+    printf("serial update:    %d nodes, %.3f ms/frame\n", nodeCount, times[0] * 1000.0);
+    printf("parallel update:  %d nodes, %.3f ms/frame, %.2fx\n", nodeCount, times[1] * 1000.0, times[0] / times[1]);
+
+    MemFree(patches);
+    UnloadScene(sceneId);
+}
+
+// patches are created with their children interleaved and then partially released and
+// recreated a few times, so siblings end up scattered across the node storage
+static void CreateFragmentedPatches(SceneId sceneId, SceneModelId modelId, SceneNodeId *patches, int patchCount)
+{
+    for (int i = 0; i < patchCount; i++)
+    {
+        patches[i] = AcquireSceneNode(sceneId);
+    }
+
+    for (int j = 0; j < BENCH_PATCH_SIZE; j++)
+    {
+        for (int i = 0; i < patchCount; i++)
+        {
+            SceneNodeId child = AcquireSceneNode(sceneId);
+            SetSceneNodeModel(child, modelId);
+            SetSceneNodePosition(child, GetRandomValue(-400, 400) * 0.01f, 0, GetRandomValue(-400, 400) * 0.01f);
+            SetSceneNodeRotation(child, 0, GetRandomValue(0, 360), 0);
+            SetSceneNodeParent(child, patches[GetRandomValue(0, patchCount - 1)]);
+        }
+    }
+}
+
+static void BenchCompactScene(Model firTree)
+{
+    SceneId sceneId = LoadScene();
+    SceneModelId firTreeId = AddModelToScene(sceneId, firTree, "fir tree", 0);
+
+    int patchCount = BENCH_NODE_COUNT / (BENCH_PATCH_SIZE + 1);
+    SceneNodeId *patches = MemAlloc(sizeof(SceneNodeId) * patchCount);
+    SceneNodeId *recreated = MemAlloc(sizeof(SceneNodeId) * patchCount);
+    CreateFragmentedPatches(sceneId, firTreeId, patches, patchCount);
+    for (int round = 0; round < 4; round++)
+    {
+        int recreatedCount = 0;
+        for (int i = 0; i < patchCount; i++)
+        {
+            if (GetRandomValue(0, 1))
+            {
+                ReleaseSceneNode(patches[i]);
+                recreatedCount++;
+            }
+        }
+        CreateFragmentedPatches(sceneId, firTreeId, recreated, recreatedCount);
+        for (int i = 0, j = 0; i < patchCount; i++)
+        {
+            if (!IsSceneNodeValid(patches[i]))
+            {
+                patches[i] = recreated[j++];
+            }
+        }
+    }
+    // a tail of released nodes that compaction gives back
+    int tailCount = patchCount / 4;
+    CreateFragmentedPatches(sceneId, firTreeId, recreated, tailCount);
+    for (int i = 0; i < tailCount; i++)
+    {
+        ReleaseSceneNode(recreated[i]);
+    }
+
+    double times[2];
+    double compactTime = 0;
+    for (int compacted = 0; compacted < 2; compacted++)
+    {
+        if (compacted)
+        {
+            double start = GetTime();
+            CompactScene(sceneId);
+            compactTime = GetTime() - start;
+        }
+
+        double start = GetTime();
+        for (int frame = 0; frame < BENCH_FRAMES; frame++)
+        {
+            for (int i = 0; i < patchCount; i++)
+            {
+                SetSceneNodeRotation(patches[i], 0, frame * 2.0f, 0);
+            }
+            UpdateSceneTransforms(sceneId);
+        }
+        times[compacted] = (GetTime() - start) / BENCH_FRAMES;
+    }
+
+    printf("fragmented update: %.3f ms/frame, compacted %.3f ms/frame, %.2fx; compaction %.3f ms\n",
+        times[0] * 1000.0, times[1] * 1000.0, times[0] / times[1], compactTime * 1000.0);
+
+    MemFree(recreated);
+    MemFree(patches);
+    UnloadScene(sceneId);
+}
+
+// naming all nodes of the tree patches and finding an attachment point of every patch by path,
+// compared to a linear search over the node names
+static void BenchNameLookup(Model firTree)
+{
+    SceneId sceneId = LoadScene();
+    SceneModelId firTreeId = AddModelToScene(sceneId, firTree, "fir tree", 0);
+
+    int patchCount = BENCH_NODE_COUNT / (BENCH_PATCH_SIZE + 2);
+    SceneNodeId *patches = MemAlloc(sizeof(SceneNodeId) * patchCount);
+    SceneNodeId *nodes = MemAlloc(sizeof(SceneNodeId) * BENCH_NODE_COUNT);
+    int nodeCount = 0;
+    for (int i = 0; i < patchCount; i++)
+    {
+        patches[i] = CreateTreePatch(sceneId, firTreeId, BENCH_PATCH_SIZE);
+        AcquireSceneNodesEx(sceneId, 1, patches[i], &nodes[nodeCount++]);
+    }
+
+    double start = GetTime();
+    for (int i = 0; i < patchCount; i++)
+    {
+        SetSceneNodeName(patches[i], TextFormat("patch%d", i));
+        SetSceneNodeName(nodes[i], "attachment");
+    }
+    double nameTime = GetTime() - start;
+
+    int found = 0;
+    start = GetTime();
+    for (int i = 0; i < patchCount; i++)
+    {
+        found += IsSceneNodeValid(FindSceneNodeByPath(sceneId, TextFormat("patch%d/attachment", i)));
+    }
+    double pathTime = (GetTime() - start) / patchCount;
+
+    // the linear search is only run for a few patches
+    int searchCount = 20;
+    start = GetTime();
+    for (int i = 0; i < searchCount; i++)
+    {
+        const char *name = TextFormat("patch%d", patchCount - 1 - i);
+        for (int j = 0; j < patchCount; j++)
+        {
+            const char *patchName = GetSceneNodeName(patches[j]);
+            if (patchName && strcmp(patchName, name) == 0)
+            {
+                found++;
+                break;
+            }
+        }
+    }
+    double searchTime = (GetTime() - start) / searchCount;
+
+    printf("name lookup:      %d names %.3f ms, path lookup %.3f us, linear search %.3f us (%d found)\n",
+        patchCount * 2, nameTime * 1000.0, pathTime * 1000000.0, searchTime * 1000000.0, found);
+
+    MemFree(nodes);
+    MemFree(patches);
+    UnloadScene(sceneId);
+}
+
+// loading and unloading a level of named tree patches, with the default allocator and with
+// the built-in arena
+static void BenchSceneArena(Model firTree)
+{
+    int patchCount = BENCH_NODE_COUNT / (BENCH_PATCH_SIZE + 1);
+    unsigned long arenaSize = 32*1024*1024;
+    void *arenaMemory = MemAlloc(arenaSize);
+    const char *labels[3] = { "default", "arena", "reused arena" };
+    for (int arena = 0; arena < 3; arena++)
+    {
+        double loadTime = 0;
+        double unloadTime = 0;
+        for (int level = 0; level < 10; level++)
+        {
+            double start = GetTime();
+            SceneAllocator allocator = { .arenaSize = arena ? arenaSize : 0, .arenaMemory = arena == 2 ? arenaMemory : 0 };
+            SceneId sceneId = LoadSceneEx(allocator);
+            SceneModelId firTreeId = AddModelToScene(sceneId, firTree, "fir tree", 0);
+            ReserveSceneNodes(sceneId, patchCount * (BENCH_PATCH_SIZE + 1));
+            for (int i = 0; i < patchCount; i++)
+            {
+                SceneNodeId patch = CreateTreePatch(sceneId, firTreeId, BENCH_PATCH_SIZE);
+                SetSceneNodeName(patch, TextFormat("patch%d", i));
+            }
+            UpdateSceneTransforms(sceneId);
+            loadTime += GetTime() - start;
+
+            start = GetTime();
+            UnloadScene(sceneId);
+            unloadTime += GetTime() - start;
+        }
+
+        printf("level load:       %s %.3f ms, unload %.3f ms\n", labels[arena], loadTime * 100.0, unloadTime * 100.0);
+    }
+
+    MemFree(arenaMemory);
+}
+
+typedef struct BenchVelocity {
+    Vector3 velocity;
+    float damping;
+} BenchVelocity;
+
+// walking the packed components of a type compared to looking the component up per node,
+// after some churn has mixed up the pool
+static void BenchComponentIteration(void)
+{
+    RegisterSceneNodeComponent((SceneNodeComponentDefinition){ .definitionId = 1,
+        .componentDataSize = sizeof(BenchVelocity), .name = "velocity" });
+
+    SceneId sceneId = LoadScene();
+    SceneNodeId *nodes = MemAlloc(sizeof(SceneNodeId) * BENCH_NODE_COUNT);
+    ReserveSceneNodes(sceneId, BENCH_NODE_COUNT);
+    AcquireSceneNodes(sceneId, BENCH_NODE_COUNT, nodes);
+    for (int i = 0; i < BENCH_NODE_COUNT; i++)
+    {
+        BenchVelocity velocity = { { 0.0f, (float)GetRandomValue(1, 10), 0.0f }, 0.99f };
+        AddSceneNodeComponent(nodes[i], 1, &velocity);
+    }
+    for (int i = 0; i < BENCH_NODE_COUNT / 4; i++)
+    {
+        int index = GetRandomValue(0, BENCH_NODE_COUNT - 1);
+        RemoveSceneNodeComponent(FindSceneNodeComponent(nodes[index], 1));
+        AddSceneNodeComponent(nodes[index], 1, &(BenchVelocity){ { 1.0f, 0.0f, 0.0f }, 0.99f });
+    }
+
+    double times[2] = { 0 };
+    float sum = 0.0f;
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        double start = GetTime();
+        unsigned long count;
+        BenchVelocity *velocities = GetSceneComponents(sceneId, 1, &count);
+        for (unsigned long i = 0; i < count; i++)
+        {
+            velocities[i].velocity = Vector3Scale(velocities[i].velocity, velocities[i].damping);
+            sum += velocities[i].velocity.y;
+        }
+        times[0] += GetTime() - start;
+
+        start = GetTime();
+        for (int i = 0; i < BENCH_NODE_COUNT; i++)
+        {
+            BenchVelocity *velocity = GetSceneNodeComponent(FindSceneNodeComponent(nodes[i], 1));
+            velocity->velocity = Vector3Scale(velocity->velocity, velocity->damping);
+            sum += velocity->velocity.y;
+        }
+        times[1] += GetTime() - start;
+    }
+
+    printf("components:       %d components, %.3f ms packed, %.3f ms per node (%g)\n", BENCH_NODE_COUNT,
+        times[0] * 1000.0 / BENCH_FRAMES, times[1] * 1000.0 / BENCH_FRAMES, sum);
+
+    UnloadScene(sceneId);
+    MemFree(nodes);
+}
+
+typedef struct BenchEmitter {
+    Vector3 worldPosition;
+    float rate;
+    float accumulator;
+} BenchEmitter;
+
+static void UpdateBenchEmitter(BenchEmitter *emitter, Matrix worldTransform)
+{
+    emitter->worldPosition = (Vector3){ worldTransform.m12, worldTransform.m13, worldTransform.m14 };
+    emitter->accumulator += emitter->rate * (1.0f / 60.0f);
+    if (emitter->accumulator > 1.0f)
+    {
+        emitter->accumulator -= 1.0f;
+    }
+}
+
+static void UpdateBenchEmitterBatch(void *componentData, const SceneNodeId *nodeIds, const Matrix *worldTransforms, unsigned long count, void *userData)
+{
+    BenchEmitter *emitters = componentData;
+    for (unsigned long i = 0; i < count; i++)
+    {
+        UpdateBenchEmitter(&emitters[i], worldTransforms[i]);
+    }
+}
+
+// updating emitter components that need their node's world transform: one lookup and getter
+// call per node compared to the batch iteration, serial and on the worker pool
+static void BenchComponentBatches(Model firTree)
+{
+    RegisterSceneNodeComponent((SceneNodeComponentDefinition){ .definitionId = 2,
+        .componentDataSize = sizeof(BenchEmitter), .name = "emitter" });
+
+    SceneId sceneId = LoadScene();
+    SceneModelId firTreeId = AddModelToScene(sceneId, firTree, "fir tree", 0);
+    SceneNodeId *nodes = MemAlloc(sizeof(SceneNodeId) * BENCH_NODE_COUNT);
+    int nodeCount = BENCH_NODE_COUNT;
+    SceneNodeId patch = { 0 };
+    for (int i = 0; i < nodeCount; i++)
+    {
+        nodes[i] = AcquireSceneNode(sceneId);
+        if (i % (BENCH_PATCH_SIZE + 1) == 0)
+        {
+            patch = nodes[i];
+            SetSceneNodePosition(patch, GetRandomValue(-100, 100), 0, GetRandomValue(-100, 100));
+        }
+        else
+        {
+            SetSceneNodeModel(nodes[i], firTreeId);
+            SetSceneNodePosition(nodes[i], GetRandomValue(-400, 400) * 0.01f, 0, GetRandomValue(-400, 400) * 0.01f);
+            SetSceneNodeRotation(nodes[i], 0, GetRandomValue(0, 360), 0);
+            SetSceneNodeParent(nodes[i], patch);
+        }
+        AddSceneNodeComponent(nodes[i], 2, &(BenchEmitter){ .rate = (float)GetRandomValue(1, 100) });
+    }
+    UpdateSceneTransforms(sceneId);
+
+    double times[3] = { 0 };
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+        double start = GetTime();
+        for (int i = 0; i < nodeCount; i++)
+        {
+            BenchEmitter *emitter = GetSceneNodeComponent(FindSceneNodeComponent(nodes[i], 2));
+            UpdateBenchEmitter(emitter, GetSceneNodeLocalTransform(nodes[i]));
+        }
+        times[0] += GetTime() - start;
+
+        start = GetTime();
+        ForEachSceneComponentBatch(sceneId, 2, UpdateBenchEmitterBatch, 0);
+        times[1] += GetTime() - start;
+
+        start = GetTime();
+        ForEachSceneComponentBatchParallel(sceneId, 2, UpdateBenchEmitterBatch, 0);
+        times[2] += GetTime() - start;
+    }
+
+    printf("emitters:         %d components, %.3f ms per node, %.3f ms batches, %.3f ms parallel batches\n", nodeCount,
+        times[0] * 1000.0 / BENCH_FRAMES, times[1] * 1000.0 / BENCH_FRAMES, times[2] * 1000.0 / BENCH_FRAMES);
+
+    UnloadScene(sceneId);
+    MemFree(nodes);
+}
+
+#define BENCH_PREFAB_PARTS 12
+#define BENCH_PREFAB_COUNT 1000
+
+// builds a biplane-like prefab part by part, the way it's done without instantiation
+static SceneNodeId CreateBenchPrefab(SceneId sceneId, SceneModelId modelId)
+{
+    SceneNodeId root = AcquireSceneNode(sceneId);
+    SetSceneNodeName(root, "biplane");
+    SceneNodeId body = AcquireSceneNode(sceneId);
+    SetSceneNodeName(body, "body");
+    SetSceneNodeParent(body, root);
+    for (int i = 0; i < BENCH_PREFAB_PARTS - 2; i++)
+    {
+        SceneNodeId part = AcquireSceneNode(sceneId);
+        SetSceneNodeName(part, TextFormat("part%d", i));
+        SetSceneNodeModel(part, modelId);
+        SetSceneNodePosition(part, i * 0.5f - 2.0f, 0.2f * (i % 3), 0.0f);
+        SetSceneNodeRotation(part, 0.0f, 0.0f, i * 5.0f);
+        SetSceneNodeScale(part, 0.5f, 0.1f, 2.0f);
+        SetSceneNodeParent(part, body);
+        AddSceneNodeComponent(part, 2, &(BenchEmitter){ .rate = 10.0f });
+    }
+
+    return root;
+}
+
+// spawning prefabs part by part compared to cloning a template subtree
+static void BenchInstantiatePrefabs(Model firTree)
+{
+    double times[2] = { 0 };
+    for (int frame = 0; frame < 10; frame++)
+    {
+        for (int instantiate = 0; instantiate < 2; instantiate++)
+        {
+            SceneId sceneId = LoadScene();
+            SceneModelId firTreeId = AddModelToScene(sceneId, firTree, "fir tree", 0);
+            SceneNodeId prefab = CreateBenchPrefab(sceneId, firTreeId);
+
+            double start = GetTime();
+            for (int i = 0; i < BENCH_PREFAB_COUNT; i++)
+            {
+                SceneNodeId biplane = instantiate ? InstantiateSceneNodeSubtree(prefab, (SceneNodeId){ 0 }) : CreateBenchPrefab(sceneId, firTreeId);
+                SetSceneNodePosition(biplane, (float)(i % 32) * 10.0f, 50.0f, (float)(i / 32) * 10.0f);
+            }
+            times[instantiate] += GetTime() - start;
+
+            UnloadScene(sceneId);
+        }
+    }
+
+    printf("prefabs:          %d x %d nodes, %.3f ms part by part, %.3f ms instantiated\n", BENCH_PREFAB_COUNT, BENCH_PREFAB_PARTS,
+        times[0] * 100.0, times[1] * 100.0);
+}
+
+// raycasts and box queries through the spatial index against testing every node, with half of
+// the patches static
+static void BenchSpatialQueries(Model firTree)
+{
+    SceneId sceneId = LoadScene();
+    SceneModelId firTreeId = AddModelToScene(sceneId, firTree, "fir tree", 0);
+
+    int patchCount = BENCH_NODE_COUNT / (BENCH_PATCH_SIZE + 1);
+    SceneNodeId *patches = MemAlloc(sizeof(SceneNodeId) * patchCount);
+    for (int i = 0; i < patchCount; i++)
+    {
+        patches[i] = CreateTreePatch(sceneId, firTreeId, BENCH_PATCH_SIZE);
+        SetSceneNodePosition(patches[i], (i % 64) * 8.0f, 0.0f, (i / 64) * 8.0f);
+    }
+    UpdateSceneTransforms(sceneId);
+    for (int i = 0; i < patchCount; i += 2)
+    {
+        SetSceneNodeStatic(patches[i], 1);
+    }
+    UpdateSceneTransforms(sceneId);
+
+    double start = GetTime();
+    UpdateSceneSpatialIndex(sceneId);
+    double buildTime = GetTime() - start;
+
+    // a box around everything lists all nodes with models for the brute force queries
+    SceneNodeId *nodes = MemAlloc(sizeof(SceneNodeId) * BENCH_NODE_COUNT);
+    BoundingBox everything = { { -1e6f, -1e6f, -1e6f }, { 1e6f, 1e6f, 1e6f } };
+    int nodeCount = FindSceneNodesInBox(sceneId, everything, nodes, BENCH_NODE_COUNT);
+
+    Ray *rays = MemAlloc(sizeof(Ray) * BENCH_QUERY_COUNT);
+    BoundingBox *boxes = MemAlloc(sizeof(BoundingBox) * BENCH_QUERY_COUNT);
+    for (int i = 0; i < BENCH_QUERY_COUNT; i++)
+    {
+        Vector3 target = { GetRandomValue(0, 512), 0.0f, GetRandomValue(0, 250) };
+        rays[i].position = (Vector3){ GetRandomValue(-50, 550), 20.0f, GetRandomValue(-50, 300) };
+        rays[i].direction = Vector3Normalize(Vector3Subtract(target, rays[i].position));
+        boxes[i] = (BoundingBox){ Vector3Subtract(target, (Vector3){ 5.0f, 5.0f, 5.0f }), Vector3Add(target, (Vector3){ 5.0f, 5.0f, 5.0f }) };
+    }
+
+    SceneNodeId found[256];
+    int hitCount = 0;
+    long foundCount = 0;
+    start = GetTime();
+    for (int i = 0; i < BENCH_QUERY_COUNT; i++)
+    {
+        hitCount += GetRayCollisionScene(sceneId, rays[i], 0).hit;
+    }
+    double rayTime = (GetTime() - start) / BENCH_QUERY_COUNT;
+    start = GetTime();
+    for (int i = 0; i < BENCH_QUERY_COUNT; i++)
+    {
+        foundCount += FindSceneNodesInBox(sceneId, boxes[i], found, 256);
+    }
+    double boxTime = (GetTime() - start) / BENCH_QUERY_COUNT;
+
+    // the same queries on the first rays and boxes, testing the bounds of every node
+    start = GetTime();
+    for (int i = 0; i < BENCH_BRUTE_QUERY_COUNT; i++)
+    {
+        float nearest = 0.0f;
+        for (int j = 0; j < nodeCount; j++)
+        {
+            RayCollision collision = GetRayCollisionBox(rays[i], GetSceneNodeWorldBounds(nodes[j]));
+            if (collision.hit && (nearest == 0.0f || collision.distance < nearest))
+            {
+                nearest = collision.distance;
+            }
+        }
+    }
+    double bruteRayTime = (GetTime() - start) / BENCH_BRUTE_QUERY_COUNT;
+    start = GetTime();
+    for (int i = 0; i < BENCH_BRUTE_QUERY_COUNT; i++)
+    {
+        int count = 0;
+        for (int j = 0; j < nodeCount; j++)
+        {
+            count += CheckCollisionBoxes(GetSceneNodeWorldBounds(nodes[j]), boxes[i]);
+        }
+    }
+    double bruteBoxTime = (GetTime() - start) / BENCH_BRUTE_QUERY_COUNT;
+
+    // moving every dynamic node, the next query refits the dynamic tree
+    for (int i = 1; i < patchCount; i += 2)
+    {
+        Vector3 position = GetSceneNodeLocalPosition(patches[i]);
+        SetSceneNodePosition(patches[i], position.x + 0.5f, position.y, position.z);
+    }
+    UpdateSceneTransforms(sceneId);
+    start = GetTime();
+    UpdateSceneSpatialIndex(sceneId);
+    double refitTime = GetTime() - start;
+
+    printf("spatial index:    %d nodes, built in %.3f ms, refit after a move in %.3f ms\n",
+        nodeCount, buildTime * 1000.0, refitTime * 1000.0);
+    printf("raycasts:         %d of %d hit, %.2f us per ray, %.2f us testing every node\n",
+        hitCount, BENCH_QUERY_COUNT, rayTime * 1e6, bruteRayTime * 1e6);
+    printf("box queries:      %.1f nodes found on average, %.2f us per box, %.2f us testing every node\n",
+        (double)foundCount / BENCH_QUERY_COUNT, boxTime * 1e6, bruteBoxTime * 1e6);
+
+    MemFree(boxes);
+    MemFree(rays);
+    MemFree(nodes);
+    MemFree(patches);
+    UnloadScene(sceneId);
+}
+
+int main(void)
+{
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(320, 240, "Scene graph benchmark");
+    SetRandomSeed(1);
+
+    Model firTree = LoadModel("resources/firtree-1.glb");
+
+    BenchTransformsAndCulling(firTree);
+    BenchBoxFrustumTests();
+    BenchPackedBoxCulling();
+    BenchComposeMatrices(BENCH_TRANSFORM_GENERAL);
+    BenchComposeMatrices(BENCH_TRANSFORM_ROTATION_Y);
+    BenchComposeMatrices(BENCH_TRANSFORM_TRANSLATION);
+    BenchStaticSubtrees(firTree);
+    BenchAcquireNodes();
+    BenchBatchSetters();
+    BenchParallelTransforms(firTree);
+    BenchCompactScene(firTree);
+    BenchNameLookup(firTree);
+    BenchSceneArena(firTree);
+    BenchComponentIteration();
+    BenchComponentBatches(firTree);
+    BenchInstantiatePrefabs(firTree);
+    BenchSpatialQueries(firTree);
+
+    UnloadModel(firTree);
+    CloseWindow();
+
+    return 0;
+}
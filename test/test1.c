@@ -37,13 +37,9 @@ static Vector3 Vector4Transform3(Vector4 v, Matrix m)
     return (Vector3){result.x / result.w, result.y / result.w, result.z / result.w};
 }
 
-static void CalcFrustumCorners(Camera3D camera, Vector3* corners)
+static void CalcFrustumCorners(SceneDrawConfig config, Vector3* corners)
 {
-    Matrix view = GetCameraMatrix(camera);
-    Matrix proj = MatrixIdentity();
-    proj = MatrixPerspective(camera.fovy * DEG2RAD, (double)GetScreenWidth() / (double)GetScreenHeight(), 1.0f, 30.0f);
-    Matrix viewProj = MatrixMultiply(view, proj);
-    viewProj = MatrixInvert(viewProj);
+    Matrix viewProj = MatrixInvert(GetSceneViewProjection(config));
     corners[0] = Vector4Transform3((Vector4){-1, -1, -1, 1}, viewProj);
     corners[1] = Vector4Transform3((Vector4){1, -1, -1, 1}, viewProj);
     corners[2] = Vector4Transform3((Vector4){1, 1, -1, 1}, viewProj);
@@ -165,14 +161,16 @@ int main(void)
 
         BeginMode3D(externalCamera);
 
-        SceneDrawStats drawStats = DrawScene(sceneId, (SceneDrawConfig) { .camera = camera, 
+        // a short far plane makes the culling visible from the external camera
+        SceneDrawConfig drawConfig = { .camera = camera, .nearPlane = 1.0f, .farPlane = 30.0f,
             .transform = MatrixIdentity(), .layerMask = 0, 
-            .sortMode = SCENE_DRAW_SORT_NONE, .drawBoundingBoxes = drawBoundingBoxes });
+            .sortMode = SCENE_DRAW_SORT_NONE, .drawBoundingBoxes = drawBoundingBoxes };
+        SceneDrawStats drawStats = DrawScene(sceneId, drawConfig);
 
         if (useExternalCamera)
         {
             Vector3 corners[8];
-            CalcFrustumCorners(camera, corners);
+            CalcFrustumCorners(drawConfig, corners);
             
             DrawLine3D(corners[0], corners[1], BLUE);
             DrawLine3D(corners[1], corners[2], BLUE);
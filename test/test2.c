@@ -0,0 +1,646 @@
+#include "raylib.h"
+#include "raymath.h"
+#include "scene.h"
+#include <stdio.h>
+#include <string.h>
+
+// Headless scene graph tests: random sequences of operations are checked against a simple model
+// of the expected state. Prints the failed checks and returns their count. Run from the repository
+// root so the resources can be found; the hidden window is only there because loading models
+// requires a GL context.
+
+#define TEST_NODE_STEPS 20000
+#define TEST_NODE_COUNT 1024
+#define TEST_NAME_COUNT 32
+#define TEST_CHECK_INTERVAL 250
+#define TEST_MAX_REPORTS 20
+#define TEST_QUERY_NODE_COUNT 2000
+#define TEST_QUERY_ROUNDS 100
+#define TEST_QUERIES_PER_ROUND 20
+#define TEST_CULL_NODE_COUNT 600
+#define TEST_CULL_GROUP_SIZE 8
+
+static int failedCheckCount = 0;
+
+#define CHECK(condition) CheckCondition((condition), #condition, __LINE__)
+
+static void CheckCondition(int condition, const char *text, int line)
+{
+    if (!condition)
+    {
+        if (failedCheckCount < TEST_MAX_REPORTS)
+        {
+            printf("test2.c:%d: check failed: %s\n", line, text);
+        }
+        failedCheckCount++;
+    }
+}
+
+static int IsSameSceneNode(SceneNodeId a, SceneNodeId b)
+{
+    return a.sceneId.id == b.sceneId.id && a.id == b.id && a.generation == b.generation;
+}
+
+// the expected state of a node; parent and name index into the model and the name pool, -1 for none.
+// The local positions are whole numbers, so the world positions are exact sums along the parents
+typedef struct TestNode {
+    SceneNodeId id;
+    SceneNodeHandle handle;
+    Vector3 position;
+    int parent;
+    int name;
+    int isAlive;
+} TestNode;
+
+static char testNames[TEST_NAME_COUNT][16];
+
+static int IsTestNodeInSubtree(TestNode *nodes, int node, int root)
+{
+    for (int i = node; i >= 0; i = nodes[i].parent)
+    {
+        if (i == root)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int FindTestNode(TestNode *nodes, int nodeCount, SceneNodeId id)
+{
+    for (int i = 0; i < nodeCount; i++)
+    {
+        if (nodes[i].isAlive && IsSameSceneNode(nodes[i].id, id))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static int GetRandomTestNode(TestNode *nodes, int nodeCount, int isAlive)
+{
+    if (nodeCount == 0)
+    {
+        return -1;
+    }
+
+    // a few probes are enough; the caller skips the step if none matches
+    for (int attempt = 0; attempt < 8; attempt++)
+    {
+        int i = GetRandomValue(0, nodeCount - 1);
+        if (nodes[i].isAlive == isAlive)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void CheckTestNodes(SceneId sceneId, TestNode *nodes, int nodeCount)
+{
+    UpdateSceneTransforms(sceneId);
+
+    for (int i = 0; i < nodeCount; i++)
+    {
+        SceneNodeId id = nodes[i].id;
+        if (!nodes[i].isAlive)
+        {
+            // released ids keep failing, also with their generation negated as it is stored internally
+            SceneNodeId negated = id;
+            negated.generation = -id.generation;
+            CHECK(!IsSceneNodeValid(id));
+            CHECK(!IsSceneNodeValid(negated));
+            CHECK(GetSceneNodeHandle(negated) == 0);
+            CHECK(GetSceneNodeName(negated) == 0);
+            CHECK(!IsSceneNodeHandleValid(nodes[i].handle));
+            CHECK(!IsSceneNodeValid(GetSceneNodeIdFromHandle(nodes[i].handle)));
+            continue;
+        }
+
+        CHECK(IsSceneNodeValid(id));
+        CHECK(GetSceneNodeHandle(id) == nodes[i].handle);
+        CHECK(IsSceneNodeHandleValid(nodes[i].handle));
+        CHECK(IsSameSceneNode(GetSceneNodeIdFromHandle(nodes[i].handle), id));
+
+        Vector3 position = { 0 };
+        for (int j = i; j >= 0; j = nodes[j].parent)
+        {
+            position = Vector3Add(position, nodes[j].position);
+        }
+        Vector3 worldPosition = GetSceneNodeWorldPosition(id);
+        CHECK(worldPosition.x == position.x && worldPosition.y == position.y && worldPosition.z == position.z);
+
+        const char *name = GetSceneNodeName(id);
+        if (nodes[i].name >= 0)
+        {
+            CHECK(name && strcmp(name, testNames[nodes[i].name]) == 0);
+
+            // any child of the parent with the same name may be returned
+            if (nodes[i].parent >= 0)
+            {
+                SceneNodeId found = FindSceneNodeChildByName(nodes[nodes[i].parent].id, name);
+                int foundNode = FindTestNode(nodes, nodeCount, found);
+                CHECK(foundNode >= 0 && nodes[foundNode].parent == nodes[i].parent && nodes[foundNode].name == nodes[i].name);
+            }
+        }
+        else
+        {
+            CHECK(!name || name[0] == '\0');
+        }
+    }
+
+    for (int n = 0; n < TEST_NAME_COUNT; n++)
+    {
+        int namedCount = 0;
+        for (int i = 0; i < nodeCount; i++)
+        {
+            namedCount += nodes[i].isAlive && nodes[i].name == n;
+        }
+
+        SceneNodeId found = FindSceneNodeByName(sceneId, testNames[n]);
+        if (namedCount > 0)
+        {
+            int foundNode = FindTestNode(nodes, nodeCount, found);
+            CHECK(foundNode >= 0 && nodes[foundNode].name == n);
+        }
+        else
+        {
+            CHECK(!IsSceneNodeValid(found));
+        }
+    }
+}
+
+// acquires, moves, names, reparents, releases and compacts nodes at random in a scene using the allocator
+static void TestNodeSequences(SceneAllocator allocator)
+{
+    static TestNode nodes[TEST_NODE_COUNT];
+    int nodeCount = 0;
+    for (int n = 0; n < TEST_NAME_COUNT; n++)
+    {
+        snprintf(testNames[n], sizeof(testNames[n]), "node%d", n);
+    }
+
+    SceneId sceneId = LoadSceneEx(allocator);
+    CHECK(IsSceneValid(sceneId));
+    CHECK(!IsSceneNodeHandleValid(0));
+    CHECK(!IsSceneNodeValid(GetSceneNodeIdFromHandle(0)));
+
+    for (int step = 0; step < TEST_NODE_STEPS; step++)
+    {
+        int operation = GetRandomValue(0, 99);
+        if (operation < 30)
+        {
+            // once the model is full, entries of released nodes are reused
+            int i = nodeCount < TEST_NODE_COUNT ? nodeCount++ : GetRandomTestNode(nodes, nodeCount, 0);
+            if (i < 0)
+            {
+                continue;
+            }
+
+            int parent = GetRandomValue(0, 3) > 0 ? GetRandomTestNode(nodes, nodeCount, 1) : -1;
+            if (parent == i)
+            {
+                parent = -1;
+            }
+            Vector3 position = { GetRandomValue(-100, 100), GetRandomValue(-100, 100), GetRandomValue(-100, 100) };
+            nodes[i] = (TestNode){ AcquireSceneNode(sceneId), 0, position, parent, -1, 1 };
+            nodes[i].handle = GetSceneNodeHandle(nodes[i].id);
+            SetSceneNodePositionV(nodes[i].id, position);
+            if (parent >= 0)
+            {
+                SetSceneNodeParent(nodes[i].id, nodes[parent].id);
+            }
+        }
+        else if (operation < 50)
+        {
+            int i = GetRandomTestNode(nodes, nodeCount, 1);
+            int parent = GetRandomTestNode(nodes, nodeCount, 1);
+            if (i >= 0 && parent >= 0 && !IsTestNodeInSubtree(nodes, parent, i))
+            {
+                SetSceneNodeParent(nodes[i].id, nodes[parent].id);
+                nodes[i].parent = parent;
+            }
+        }
+        else if (operation < 60)
+        {
+            int i = GetRandomTestNode(nodes, nodeCount, 1);
+            if (i >= 0)
+            {
+                nodes[i].position = (Vector3){ GetRandomValue(-100, 100), GetRandomValue(-100, 100), GetRandomValue(-100, 100) };
+                SetSceneNodePositionV(nodes[i].id, nodes[i].position);
+            }
+        }
+        else if (operation < 70)
+        {
+            int i = GetRandomTestNode(nodes, nodeCount, 1);
+            if (i >= 0)
+            {
+                nodes[i].name = GetRandomValue(0, 7) > 0 ? GetRandomValue(0, TEST_NAME_COUNT - 1) : -1;
+                CHECK(SetSceneNodeName(nodes[i].id, nodes[i].name >= 0 ? testNames[nodes[i].name] : 0));
+            }
+        }
+        else if (operation < 85)
+        {
+            int root = GetRandomTestNode(nodes, nodeCount, 1);
+            if (root >= 0)
+            {
+                SceneNodeId rootId = nodes[root].id;
+                for (int i = 0; i < nodeCount; i++)
+                {
+                    if (nodes[i].isAlive && i != root && IsTestNodeInSubtree(nodes, i, root))
+                    {
+                        nodes[i].isAlive = 0;
+                    }
+                }
+                nodes[root].isAlive = 0;
+
+                if (step & 1)
+                {
+                    ReleaseSceneNode(rootId);
+                }
+                else
+                {
+                    ReleaseSceneNodeSubtree(rootId);
+                }
+
+                // releasing again or through a stale id is a no-op
+                ReleaseSceneNode(rootId);
+                CHECK(!IsSceneNodeValid(rootId));
+                CHECK(!SetSceneNodeName(rootId, testNames[0]));
+            }
+        }
+        else if (operation < 87)
+        {
+            CompactScene(sceneId);
+        }
+
+        if (step % TEST_CHECK_INTERVAL == 0)
+        {
+            CheckTestNodes(sceneId, nodes, nodeCount);
+        }
+    }
+
+    CompactScene(sceneId);
+    CheckTestNodes(sceneId, nodes, nodeCount);
+    UnloadScene(sceneId);
+    CHECK(!IsSceneValid(sceneId));
+}
+
+// counts the live allocations of the scenes using it; new memory is filled with garbage,
+// so a scene relying on zeroed memory fails the checks
+typedef struct TestAllocations {
+    int liveCount;
+    int allocateCount;
+} TestAllocations;
+
+static void *AllocateTestMemory(void *userData, unsigned long size)
+{
+    TestAllocations *allocations = userData;
+    allocations->liveCount++;
+    allocations->allocateCount++;
+    void *memory = MemAlloc(size);
+    memset(memory, 0xcd, size);
+    return memory;
+}
+
+static void *ReallocateTestMemory(void *userData, void *memory, unsigned long size)
+{
+    return MemRealloc(memory, size);
+}
+
+static void ReleaseTestMemory(void *userData, void *memory)
+{
+    TestAllocations *allocations = userData;
+    allocations->liveCount--;
+    MemFree(memory);
+}
+
+// runs the node sequences with allocator callbacks, a small arena and caller owned arena memory
+static void TestSceneAllocators(void)
+{
+    TestAllocations allocations = { 0 };
+    SceneAllocator callbacks = { AllocateTestMemory, ReallocateTestMemory, ReleaseTestMemory, &allocations };
+    TestNodeSequences(callbacks);
+    CHECK(allocations.allocateCount > 0);
+    CHECK(allocations.liveCount == 0);
+
+    // a small arena spreads the scene over many blocks
+    SceneAllocator arena = { .arenaSize = 4096 };
+    TestNodeSequences(arena);
+
+    // the caller's memory is dirty, as it is when a previous level used it, and the scene's
+    // data must end up in it
+    static _Alignas(16) unsigned char arenaMemory[1024*1024];
+    for (int level = 0; level < 2; level++)
+    {
+        memset(arenaMemory, 0xcd, sizeof(arenaMemory));
+        TestNodeSequences((SceneAllocator){ .arenaSize = sizeof(arenaMemory), .arenaMemory = arenaMemory });
+        unsigned long usedCount = 0;
+        for (unsigned long i = 0; i < sizeof(arenaMemory); i++)
+        {
+            usedCount += arenaMemory[i] != 0xcd;
+        }
+        CHECK(usedCount > sizeof(arenaMemory) / 4);
+    }
+
+    // scenes loaded side by side get slots of their own
+    SceneId sceneIds[8];
+    for (int i = 0; i < 8; i++)
+    {
+        sceneIds[i] = LoadSceneEx(i & 1 ? callbacks : arena);
+        AcquireSceneNode(sceneIds[i]);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        CHECK(IsSceneValid(sceneIds[i]));
+        for (int j = 0; j < i; j++)
+        {
+            CHECK(sceneIds[i].id != sceneIds[j].id);
+        }
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        UnloadScene(sceneIds[i]);
+        CHECK(!IsSceneValid(sceneIds[i]));
+    }
+    CHECK(allocations.liveCount == 0);
+}
+
+// the nearest hit of the bounds of all nodes with models, 0 if there is none
+static float GetTestRayDistance(TestNode *nodes, int nodeCount, Ray ray)
+{
+    float nearest = 0.0f;
+    for (int i = 0; i < nodeCount; i++)
+    {
+        if (nodes[i].isAlive)
+        {
+            RayCollision collision = GetRayCollisionBox(ray, GetSceneNodeWorldBounds(nodes[i].id));
+            if (collision.hit && (nearest == 0.0f || collision.distance < nearest))
+            {
+                nearest = collision.distance;
+            }
+        }
+    }
+
+    return nearest;
+}
+
+// checks that the found nodes are exactly the model nodes that overlap the box, or the sphere if radius isn't negative
+static void CheckTestOverlaps(TestNode *nodes, int nodeCount, BoundingBox box, Vector3 center, float radius, SceneNodeId *found, int foundCount)
+{
+    int expectedCount = 0;
+    for (int i = 0; i < nodeCount; i++)
+    {
+        BoundingBox bounds = GetSceneNodeWorldBounds(nodes[i].id);
+        if (nodes[i].isAlive && (radius >= 0.0f ? CheckCollisionBoxSphere(bounds, center, radius) : CheckCollisionBoxes(bounds, box)))
+        {
+            expectedCount++;
+        }
+    }
+    CHECK(foundCount == expectedCount);
+
+    for (int j = 0; j < foundCount && j < TEST_QUERY_NODE_COUNT; j++)
+    {
+        int i = FindTestNode(nodes, nodeCount, found[j]);
+        CHECK(i >= 0);
+        if (i >= 0)
+        {
+            BoundingBox bounds = GetSceneNodeWorldBounds(nodes[i].id);
+            CHECK(radius >= 0.0f ? CheckCollisionBoxSphere(bounds, center, radius) : CheckCollisionBoxes(bounds, box));
+        }
+    }
+}
+
+// moves, reparents, releases and freezes nodes with models at random, and compares the results of
+// the spatial queries with tests of the bounds of every node
+static void TestSpatialQueries(Model model)
+{
+    static TestNode nodes[TEST_QUERY_NODE_COUNT];
+    static SceneNodeId found[TEST_QUERY_NODE_COUNT];
+    SceneId sceneId = LoadScene();
+    SceneModelId modelId = AddModelToScene(sceneId, model, "model", 0);
+
+    int nodeCount = TEST_QUERY_NODE_COUNT / 2;
+    for (int i = 0; i < TEST_QUERY_NODE_COUNT; i++)
+    {
+        nodes[i].id = AcquireSceneNode(sceneId);
+        nodes[i].parent = -1;
+        nodes[i].isAlive = i < nodeCount;
+        SetSceneNodeModel(nodes[i].id, modelId);
+        SetSceneNodePosition(nodes[i].id, GetRandomValue(-100, 100), 0.0f, GetRandomValue(-100, 100));
+        if (!nodes[i].isAlive)
+        {
+            ReleaseSceneNode(nodes[i].id);
+        }
+    }
+
+    for (int round = 0; round < TEST_QUERY_ROUNDS; round++)
+    {
+        for (int step = 0; step < 20; step++)
+        {
+            int operation = GetRandomValue(0, 99);
+            int i = GetRandomTestNode(nodes, nodeCount, 1);
+            if (operation < 10)
+            {
+                // replaces a released node with a new one
+                int j = GetRandomTestNode(nodes, TEST_QUERY_NODE_COUNT, 0);
+                if (j >= 0)
+                {
+                    nodes[j] = (TestNode){ AcquireSceneNode(sceneId), 0, { 0 }, -1, -1, 1 };
+                    SetSceneNodeModel(nodes[j].id, modelId);
+                    SetSceneNodePosition(nodes[j].id, GetRandomValue(-100, 100), GetRandomValue(0, 10), GetRandomValue(-100, 100));
+                    nodeCount = j >= nodeCount ? j + 1 : nodeCount;
+                }
+            }
+            else if (i < 0)
+            {
+                continue;
+            }
+            else if (operation < 60)
+            {
+                SetSceneNodePosition(nodes[i].id, GetRandomValue(-100, 100), GetRandomValue(0, 10), GetRandomValue(-100, 100));
+                SetSceneNodeRotation(nodes[i].id, 0.0f, GetRandomValue(0, 360), GetRandomValue(-20, 20));
+                float scale = GetRandomValue(50, 100) * 0.01f;
+                SetSceneNodeScale(nodes[i].id, scale, scale, scale);
+            }
+            else if (operation < 75)
+            {
+                int parent = GetRandomTestNode(nodes, nodeCount, 1);
+                if (parent >= 0 && !IsTestNodeInSubtree(nodes, parent, i))
+                {
+                    SetSceneNodeParent(nodes[i].id, nodes[parent].id);
+                    nodes[i].parent = parent;
+                }
+            }
+            else if (operation < 90)
+            {
+                SetSceneNodeStatic(nodes[i].id, GetRandomValue(0, 1));
+            }
+            else
+            {
+                for (int j = 0; j < nodeCount; j++)
+                {
+                    if (nodes[j].isAlive && j != i && IsTestNodeInSubtree(nodes, j, i))
+                    {
+                        nodes[j].isAlive = 0;
+                    }
+                }
+                nodes[i].isAlive = 0;
+                ReleaseSceneNode(nodes[i].id);
+            }
+        }
+
+        // some rounds query before the transforms are updated, which answers for the previous update
+        if (round % 4 == 0)
+        {
+            FindSceneNodesInBox(sceneId, (BoundingBox){ { -10, -10, -10 }, { 10, 10, 10 } }, found, TEST_QUERY_NODE_COUNT);
+        }
+        UpdateSceneTransforms(sceneId);
+
+        for (int query = 0; query < TEST_QUERIES_PER_ROUND; query++)
+        {
+            // the rays start far above the nodes, outside of their bounds, and half of them aim at a node
+            Vector3 target = { GetRandomValue(-120, 120), 0.0f, GetRandomValue(-120, 120) };
+            int targetNode = query & 1 ? GetRandomTestNode(nodes, nodeCount, 1) : -1;
+            if (targetNode >= 0)
+            {
+                target = GetSceneNodeWorldPosition(nodes[targetNode].id);
+            }
+            Ray ray = { { GetRandomValue(-150, 150), 1000.0f, GetRandomValue(-150, 150) }, { 0 } };
+            ray.direction = Vector3Normalize(Vector3Subtract(target, ray.position));
+            SceneNodeId hitNode;
+            RayCollision collision = GetRayCollisionScene(sceneId, ray, &hitNode);
+            float distance = GetTestRayDistance(nodes, nodeCount, ray);
+            CHECK(collision.hit == (distance > 0.0f));
+            if (collision.hit)
+            {
+                CHECK(fabsf(collision.distance - distance) <= 1e-3f * distance);
+                CHECK(FindTestNode(nodes, nodeCount, hitNode) >= 0);
+            }
+
+            float size = GetRandomValue(1, 40);
+            BoundingBox box = { Vector3Subtract(target, (Vector3){ size, size, size }), Vector3Add(target, (Vector3){ size, size, size }) };
+            int foundCount = FindSceneNodesInBox(sceneId, box, found, TEST_QUERY_NODE_COUNT);
+            CheckTestOverlaps(nodes, nodeCount, box, target, -1.0f, found, foundCount);
+
+            foundCount = FindSceneNodesInSphere(sceneId, target, size, found, TEST_QUERY_NODE_COUNT);
+            CheckTestOverlaps(nodes, nodeCount, box, target, size, found, foundCount);
+        }
+    }
+
+    UnloadScene(sceneId);
+}
+
+// a parent's non-uniform scale shears its rotated children, and then the length of their axes
+// underestimates how far their meshes reach; the bounding sphere test must not cull them
+static void TestShearedCulling(void)
+{
+    Model cube = LoadModelFromMesh(GenMeshCube(1.0f, 1.0f, 1.0f));
+    SceneId sceneId = LoadScene();
+    SceneModelId cubeId = AddModelToScene(sceneId, cube, "cube", 0);
+    SceneNodeId parent = AcquireSceneNode(sceneId);
+    SceneNodeId child = AcquireSceneNode(sceneId);
+    SetSceneNodeScale(parent, 10.0f, 1.0f, 1.0f);
+    SetSceneNodeRotation(child, 0.0f, 0.0f, 45.0f);
+    SetSceneNodeModel(child, cubeId);
+    SetSceneNodeParent(child, parent);
+
+    // a corner of the cube reaches x = 7.07, while the sphere scaled by the longest axis ends at 6.15
+    SceneDrawConfig config = { .camera = { .position = { 6.6f, 0.0f, 10.0f }, .target = { 6.6f, 0.0f, 0.0f },
+        .up = { 0.0f, 1.0f, 0.0f }, .fovy = 2.0f, .projection = CAMERA_PERSPECTIVE }, .aspect = 1.0f, .transform = MatrixIdentity() };
+    SceneDrawStats stats = DrawScene(sceneId, config);
+    CHECK(stats.meshDrawCount == 1);
+
+    config.camera.position.x = 9.0f;
+    config.camera.target.x = 9.0f;
+    stats = DrawScene(sceneId, config);
+    CHECK(stats.meshDrawCount == 0);
+
+    UnloadScene(sceneId);
+    UnloadModel(cube);
+}
+
+// DrawScene tests leaves and the own bounds of inner nodes in batches; it must draw exactly the
+// meshes whose oriented box is visible, also across several batches and for an inner node that is
+// outside while its child is inside
+static void TestBatchedCulling(void)
+{
+    static SceneNodeId nodes[TEST_CULL_NODE_COUNT];
+    Model cube = LoadModelFromMesh(GenMeshCube(1.0f, 1.0f, 1.0f));
+    SceneId sceneId = LoadScene();
+    SceneModelId cubeId = AddModelToScene(sceneId, cube, "cube", 0);
+    for (int i = 0; i < TEST_CULL_NODE_COUNT; i++)
+    {
+        nodes[i] = AcquireSceneNode(sceneId);
+        SetSceneNodeModel(nodes[i], cubeId);
+        SetSceneNodePosition(nodes[i], GetRandomValue(-400, 400) / 10.0f, GetRandomValue(-400, 400) / 10.0f, GetRandomValue(-400, 400) / 10.0f);
+        SetSceneNodeRotation(nodes[i], GetRandomValue(0, 359), GetRandomValue(0, 359), 0.0f);
+        if (i % TEST_CULL_GROUP_SIZE != 0)
+        {
+            SetSceneNodeParent(nodes[i], nodes[i - i % TEST_CULL_GROUP_SIZE]);
+        }
+    }
+    SceneNodeId outsideParent = AcquireSceneNode(sceneId);
+    SceneNodeId insideChild = AcquireSceneNode(sceneId);
+    SetSceneNodeModel(outsideParent, cubeId);
+    SetSceneNodeModel(insideChild, cubeId);
+    SetSceneNodePosition(outsideParent, -60.0f, 0.0f, 0.0f);
+    SetSceneNodePosition(insideChild, 60.0f, 0.0f, 0.0f);
+    SetSceneNodeParent(insideChild, outsideParent);
+
+    SceneDrawConfig config = { .camera = { .position = { 0.0f, 0.0f, 50.0f }, .target = { 0.0f, 0.0f, 0.0f },
+        .up = { 0.0f, 1.0f, 0.0f }, .fovy = 45.0f, .projection = CAMERA_PERSPECTIVE }, .aspect = 1.0f,
+        .farPlane = 100.0f, .transform = MatrixIdentity() };
+    SceneDrawStats stats = DrawScene(sceneId, config);
+
+    Vector4 planes[6];
+    GetSceneFrustumPlanes(GetSceneViewProjection(config), planes);
+    BoundingBox box = GetMeshBoundingBox(cube.meshes[0]);
+    unsigned long visibleCount = 1;
+    for (int i = 0; i < TEST_CULL_NODE_COUNT; i++)
+    {
+        Matrix matrix;
+        GetSceneNodeWorldMatricesBatch(&nodes[i], &matrix, 1);
+        visibleCount += CheckCollisionBoxFrustum(box, planes, matrix);
+    }
+    CHECK(stats.meshDrawCount == visibleCount);
+    CHECK(stats.meshDrawCount + stats.culledMeshCount == TEST_CULL_NODE_COUNT + 2);
+    CHECK(stats.culledNodeCount >= 1);
+
+    UnloadScene(sceneId);
+    UnloadModel(cube);
+}
+
+int main(void)
+{
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(320, 240, "Scene graph tests");
+    SetRandomSeed(1);
+
+    Model firTree = LoadModel("resources/firtree-1.glb");
+
+    TestNodeSequences((SceneAllocator){ 0 });
+    TestSceneAllocators();
+    TestSpatialQueries(firTree);
+    TestShearedCulling();
+    TestBatchedCulling();
+
+    UnloadModel(firTree);
+    CloseWindow();
+
+    if (failedCheckCount > 0)
+    {
+        printf("%d checks failed\n", failedCheckCount);
+    }
+    else
+    {
+        printf("all checks passed\n");
+    }
+
+    return failedCheckCount;
+}